@@ -0,0 +1,85 @@
+#pragma once
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "models/Employee.h"
+#include "models/Computer.h"
+
+// Общие для бенчмарков генераторы записей и замер времени
+namespace bench {
+
+inline Employee makeEmployee(int i) {
+    Employee e{};
+    e.id = i + 1;
+    e.institute = "Институт " + std::to_string(i % 7);
+    e.department = "Кафедра " + std::to_string(i % 40);
+    e.lastName = "Иванов" + std::to_string(i);
+    e.initials = "И.И.";
+    e.position = i % 5 ? "Доцент" : "Заведующий кафедрой";
+    e.phone = "+7 (495) 123-" + std::to_string(1000 + i % 9000);
+    e.email = "user" + std::to_string(i) + "@university.ru";
+    e.employmentDate = "01.02.2020";
+    e.status = i % 10 ? "Работает" : "Уволен";
+    return e;
+}
+
+inline Computer makeComputer(int i) {
+    Computer c{};
+    c.id = i + 1;
+    c.inventoryNumber = "INV-" + std::to_string(i);
+    c.serialNumber = "SN-" + std::to_string(i);
+    c.manufacturer = i % 3 ? "Dell" : "Lenovo";
+    c.model = "OptiPlex " + std::to_string(3000 + i % 20);
+    c.cpuModel = "Intel Core i5-" + std::to_string(8000 + i % 500);
+    c.chipset = "Q370";
+    c.ramSize = 4 << (i % 4);
+    c.storageType = i % 2 ? "SSD" : "HDD";
+    c.storageSize = 256 << (i % 3);
+    c.roomNumber = std::to_string(100 + i % 300);
+    c.condition = i % 20 ? "Рабочее" : "На ремонте";
+    c.commissioningDate = "01.09.2019";
+    c.lastMaintenanceDate = "15.03.2024";
+    c.warrantyExpirationDate = "01.09.2030";
+    return c;
+}
+
+// Сотрудники и компьютеры поровну, каждый второй сотрудник с компьютером
+inline void makeRecords(size_t count, std::vector<Employee>& employees, std::vector<Computer>& computers) {
+    employees.clear();
+    computers.clear();
+    employees.reserve(count / 2);
+    computers.reserve(count - count / 2);
+    for (size_t i = 0; i < count - count / 2; ++i)
+        computers.push_back(makeComputer(static_cast<int>(i)));
+    for (size_t i = 0; i < count / 2; ++i) {
+        employees.push_back(makeEmployee(static_cast<int>(i)));
+        if (i % 2 == 0 && i < computers.size())
+            employees.back().computerId = computers[i].id;
+    }
+}
+
+// Лучшее из repeats измерений f(), в миллисекундах
+template <typename F>
+double bestOf(int repeats, F f) {
+    double best = 0;
+    for (int r = 0; r < repeats; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (r == 0 || ms < best)
+            best = ms;
+    }
+    return best;
+}
+
+inline double megabytesPerSecond(size_t bytes, double ms) {
+    return ms > 0 ? bytes / (1024.0 * 1024.0) / (ms / 1000.0) : 0;
+}
+
+// Размер из первого аргумента командной строки или значение по умолчанию
+inline size_t argument(int argc, char** argv, int index, size_t fallback) {
+    return argc > index ? static_cast<size_t>(std::strtoull(argv[index], nullptr, 10)) : fallback;
+}
+
+}
@@ -0,0 +1,64 @@
+// Размер файла, время сохранения и время открытия базы со сжатием LZ4
+// и без него для одного набора записей.
+//
+//   CompressionBenchmark [записей, по умолчанию 200000] [файл]
+
+#include "BenchmarkData.h"
+#include "storage/StorageService.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+static size_t fileSize(const std::string& path) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    return in ? static_cast<size_t>(in.tellg()) : 0;
+}
+
+int main(int argc, char** argv) {
+    size_t count = bench::argument(argc, argv, 1, 200000);
+    std::string path = argc > 2 ? argv[2] : "compression_benchmark.db";
+
+    std::vector<Employee> employees;
+    std::vector<Computer> computers;
+    bench::makeRecords(count, employees, computers);
+    const DatabaseSnapshot records{ RecordTable<Employee>(std::move(employees)),
+                                    RecordTable<Computer>(std::move(computers)) };
+
+    // Ключ с небольшим числом итераций PBKDF2, как в LoadBenchmark
+    const std::string password = "benchmark";
+    CryptoKey key = CryptoService::deriveKey(password, CryptoService::makeKdfParams(1000));
+
+    const struct {
+        compression::Codec codec;
+        const char* name;
+    } codecs[] = {
+        { compression::Codec::None, "none" },
+        { compression::Codec::Lz4, "lz4" },
+    };
+
+    for (const auto& variant : codecs) {
+        StorageService storage;
+        storage.setCompression(variant.codec);
+
+        double saveMs = bench::bestOf(5, [&]() { storage.saveSnapshot(records, path, key); });
+        size_t bytes = fileSize(path);
+
+        size_t loaded = 0;
+        double loadMs = bench::bestOf(5, [&]() {
+            Database db = storage.loadDatabase(path, password);
+            loaded = db.getEmployees().size() + db.getComputers().size();
+        });
+
+        if (loaded != count) {
+            std::cerr << "loaded " << loaded << " of " << count << " records\n";
+            return 1;
+        }
+
+        std::cout << variant.name << ": " << bytes / 1024 << " KB, "
+                  << "save " << saveMs << " ms, load " << loadMs << " ms\n";
+    }
+
+    std::remove(path.c_str());
+    return 0;
+}
@@ -0,0 +1,73 @@
+// Скорость блочного AES-256-GCM (ChunkedEncryptor/ChunkedDecryptor)
+// в зависимости от числа потоков пула.
+//
+//   CryptoBenchmark [МБ данных, по умолчанию 256] [наибольшее число потоков]
+
+#include "BenchmarkData.h"
+#include "crypto/ChunkedCipher.h"
+#include "utils/ThreadPool.h"
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+int main(int argc, char** argv) {
+    size_t megabytes = bench::argument(argc, argv, 1, 256);
+    size_t hardware = std::max<size_t>(1, std::thread::hardware_concurrency());
+    size_t maxThreads = bench::argument(argc, argv, 2, hardware);
+
+    std::vector<unsigned char> plain(megabytes << 20);
+    for (size_t i = 0; i < plain.size(); ++i)
+        plain[i] = static_cast<unsigned char>(i * 131 + (i >> 12));
+
+    CryptoKey key = CryptoService::deriveKey("benchmark", CryptoService::makeKdfParams(1000));
+
+    std::cout << megabytes << " MB, chunk " << (chunked_cipher::kDefaultChunkSize >> 10)
+              << " KB, " << hardware << " hardware threads\n";
+
+    std::vector<size_t> threadCounts;
+    for (size_t threads = 1; threads < maxThreads; threads *= 2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(maxThreads);
+
+    for (size_t threads : threadCounts) {
+        ThreadPool pool(threads);
+
+        std::vector<unsigned char> sealed;
+        sealed.reserve(plain.size() + plain.size() / 1024 + 4096);
+        double encryptMs = bench::bestOf(3, [&]() {
+            sealed.clear();
+            ChunkedEncryptor encryptor(key, [&sealed](const unsigned char* data, size_t size) {
+                sealed.insert(sealed.end(), data, data + size);
+            }, chunked_cipher::kDefaultChunkSize, pool);
+            encryptor.write(plain.data(), plain.size());
+            encryptor.finish();
+        });
+
+        // Расшифровка идет на месте, поэтому каждый замер берет свежую копию
+        std::vector<unsigned char> buffer;
+        size_t headerSize = 0;
+        size_t plainSize = 0;
+        double decryptMs = 0;
+        for (int r = 0; r < 3; ++r) {
+            buffer = sealed;
+            double ms = bench::bestOf(1, [&]() {
+                ChunkedDecryptor decryptor(buffer.data(), buffer.size(), pool);
+                decryptor.unlock(key.key);
+                headerSize = decryptor.getHeaderSize();
+                plainSize = decryptor.decryptInPlace(buffer.data() + headerSize, buffer.size() - headerSize);
+            });
+            if (r == 0 || ms < decryptMs)
+                decryptMs = ms;
+        }
+
+        if (plainSize != plain.size() || !std::equal(plain.begin(), plain.end(), buffer.begin() + headerSize)) {
+            std::cerr << "round trip mismatch\n";
+            return 1;
+        }
+
+        std::cout << threads << " thread(s): encrypt " << bench::megabytesPerSecond(plain.size(), encryptMs)
+                  << " MB/s, decrypt " << bench::megabytesPerSecond(plain.size(), decryptMs) << " MB/s\n";
+    }
+    return 0;
+}
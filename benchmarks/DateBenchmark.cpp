@@ -0,0 +1,72 @@
+// Разбор и проверка столбца дат: по одному полю (toDayNumber + checkDay
+// для каждой записи) против пакетного parseDateColumn со статусами.
+//
+//   DateBenchmark [записей, по умолчанию 1000000]
+
+#include "BenchmarkData.h"
+#include "utils/DateUtils.h"
+
+#include <iostream>
+
+namespace {
+
+struct Row {
+    std::string date;
+    date_utils::DayNumber day = date_utils::kNoDate;
+};
+
+// Все три формата, пустые и ошибочные значения вперемешку
+std::vector<Row> makeRows(size_t count) {
+    std::vector<Row> rows(count);
+    for (size_t i = 0; i < count; ++i) {
+        std::string day = std::to_string(10 + i % 19);
+        std::string month = std::to_string(10 + i % 3);
+        std::string year = std::to_string(1990 + i % 60);
+        switch (i % 8) {
+        case 0: rows[i].date = year + "-" + month + "-" + day; break;
+        case 1: rows[i].date = day + "/" + month + "/" + year; break;
+        case 2: rows[i].date = ""; break;
+        case 3: rows[i].date = "31.02." + year; break;
+        case 4: rows[i].date = "1.1.2020"; break;
+        default: rows[i].date = day + "." + month + "." + year; break;
+        }
+    }
+    return rows;
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t count = bench::argument(argc, argv, 1, 1000000);
+    std::vector<Row> rows = makeRows(count);
+    const date_utils::DayNumber today = date_utils::today();
+
+    // Оба варианта каждый раз заводят новый вектор статусов
+    std::vector<date_utils::DateStatus> perField;
+    double perFieldMs = bench::bestOf(5, [&]() {
+        perField = std::vector<date_utils::DateStatus>(count);
+        for (size_t i = 0; i < count; ++i) {
+            rows[i].day = date_utils::toDayNumber(rows[i].date);
+            perField[i] = date_utils::checkDay(rows[i].day, today);
+        }
+    });
+    std::vector<date_utils::DayNumber> perFieldDays(count);
+    for (size_t i = 0; i < count; ++i)
+        perFieldDays[i] = rows[i].day;
+
+    std::vector<date_utils::DateStatus> batch;
+    double batchMs = bench::bestOf(5, [&]() {
+        batch = date_utils::parseDateColumn(rows, &Row::date, &Row::day, today);
+    });
+
+    for (size_t i = 0; i < count; ++i) {
+        if (batch[i] != perField[i] || rows[i].day != perFieldDays[i]) {
+            std::cerr << "mismatch at row " << i << " (" << rows[i].date << ")\n";
+            return 1;
+        }
+    }
+
+    std::cout << count << " dates: per-field " << perFieldMs << " ms, "
+              << "parseDateColumn " << batchMs << " ms\n";
+    return 0;
+}
@@ -0,0 +1,80 @@
+// Память и поиск по подстроке в фамилии: записи std::vector<Employee>
+// против плоской таблицы строковых полей (FlatTable: записи фиксированного
+// размера со ссылками в общую арену строк) и Database::findEmployeesByLastName.
+//
+//   FlatTableBenchmark [сотрудников, по умолчанию 200000] [подстрока]
+
+#include "BenchmarkData.h"
+#include "core/Database.h"
+#include "core/FlatTable.h"
+
+#include <iostream>
+
+namespace {
+
+// Отдельный блок памяти строки; короткая строка лежит внутри объекта
+size_t heapBytes(const std::string& value) {
+    const char* data = value.data();
+    const char* object = reinterpret_cast<const char*>(&value);
+    bool inside = data >= object && data < object + sizeof(value);
+    return inside ? 0 : value.capacity() + 1;
+}
+
+size_t recordsMemory(const std::vector<Employee>& employees) {
+    size_t bytes = employees.capacity() * sizeof(Employee);
+    for (const Employee& e : employees)
+        bytes += heapBytes(e.lastName) + heapBytes(e.initials) + heapBytes(e.phone) +
+                 heapBytes(e.email) + heapBytes(e.employmentDate);
+    return bytes;
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t count = bench::argument(argc, argv, 1, 200000);
+    const std::string needle = argc > 2 ? argv[2] : "777";
+
+    std::vector<Employee> employees;
+    employees.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+        employees.push_back(bench::makeEmployee(static_cast<int>(i)));
+
+    // Все строковые поля сотрудника, кроме значений из словаря
+    FlatTable<5> flat;
+    for (const Employee& e : employees)
+        flat.append(e.id, { e.lastName, e.initials, e.phone, e.email, e.employmentDate });
+    flat.compact();
+
+    std::cout << count << " employees, string fields: vector<Employee> "
+              << recordsMemory(employees) / 1024 << " KB, FlatTable "
+              << flat.memoryUsage() / 1024 << " KB\n";
+
+    size_t found = 0;
+    double vectorMs = bench::bestOf(5, [&]() {
+        found = 0;
+        for (const Employee& e : employees)
+            found += e.lastName.find(needle) != std::string::npos;
+    });
+
+    size_t flatFound = 0;
+    double flatMs = bench::bestOf(5, [&]() {
+        flatFound = 0;
+        for (size_t slot = 0; slot < flat.size(); ++slot)
+            flatFound += flat.field(slot, 0).find(needle) != std::string_view::npos;
+    });
+
+    Database db;
+    db.bulkLoad(employees, {});
+    size_t dbFound = 0;
+    double databaseMs = bench::bestOf(5, [&]() { dbFound = db.findEmployeesByLastName(needle).size(); });
+
+    if (flatFound != found || dbFound != found) {
+        std::cerr << "matches differ: " << found << ", " << flatFound << ", " << dbFound << "\n";
+        return 1;
+    }
+
+    std::cout << "lastName contains \"" << needle << "\" (" << found << " matches): "
+              << "vector<Employee> " << vectorMs << " ms, FlatTable " << flatMs << " ms, "
+              << "findEmployeesByLastName " << databaseMs << " ms\n";
+    return 0;
+}
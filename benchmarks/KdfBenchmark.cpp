@@ -0,0 +1,37 @@
+// Время выработки ключа PBKDF2-HMAC-SHA256 (CryptoService::deriveKey) при
+// разном числе итераций и подходящее число итераций для заданного времени
+// открытия файла на этой машине.
+//
+//   KdfBenchmark [желаемое время, мс, по умолчанию 200]
+
+#include "BenchmarkData.h"
+#include "crypto/CryptoService.h"
+
+#include <algorithm>
+#include <iostream>
+
+int main(int argc, char** argv) {
+    size_t targetMs = bench::argument(argc, argv, 1, 200);
+
+    const uint32_t counts[] = { 100000, 200000, 400000, CryptoService::kDefaultIterations, 1000000, 2000000 };
+    const std::string password = "benchmark password";
+
+    double msPerIteration = 0;
+    for (uint32_t iterations : counts) {
+        KdfParams params = CryptoService::makeKdfParams(iterations);
+        int repeats = iterations <= CryptoService::kDefaultIterations ? 5 : 3;
+        double ms = bench::bestOf(repeats, [&]() { CryptoService::deriveKey(password, params); });
+
+        std::cout << iterations << " iterations: " << ms << " ms"
+                  << (iterations == CryptoService::kDefaultIterations ? " (default)" : "") << "\n";
+
+        // Время растет линейно; оценка берется по самому долгому замеру
+        msPerIteration = ms / iterations;
+    }
+
+    // Округление вниз до 10 тыс. итераций, в пределах допустимых значений
+    uint64_t suggested = msPerIteration > 0 ? static_cast<uint64_t>(targetMs / msPerIteration) : 0;
+    suggested = std::min<uint64_t>(suggested / 10000 * 10000, CryptoService::kMaxIterations);
+    std::cout << "about " << suggested << " iterations take " << targetMs << " ms on this machine\n";
+    return 0;
+}
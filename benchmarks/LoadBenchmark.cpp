@@ -0,0 +1,65 @@
+// Время открытия базы от 1 тыс. до 1 млн записей: последовательное
+// декодирование разделов (Serializer::deserialize) против загрузки
+// StorageService, которая декодирует блоки разделов в общем пуле.
+//
+//   LoadBenchmark [наибольшее число записей, по умолчанию 1000000] [файл]
+
+#include "BenchmarkData.h"
+#include "storage/Serializer.h"
+#include "storage/StorageService.h"
+#include "utils/ThreadPool.h"
+
+#include <cstdio>
+#include <iostream>
+#include <utility>
+
+int main(int argc, char** argv) {
+    size_t largest = bench::argument(argc, argv, 1, 1000000);
+    std::string path = argc > 2 ? argv[2] : "load_benchmark.db";
+
+    // Сжатие отключено, ключ - с небольшим числом итераций PBKDF2:
+    // время загрузки не должно складываться в основном из них
+    StorageService storage;
+    storage.setCompression(compression::Codec::None);
+    const std::string password = "benchmark";
+    CryptoKey key = CryptoService::deriveKey(password, CryptoService::makeKdfParams(1000));
+
+    std::cout << "pool threads: " << ThreadPool::shared().size() << "\n";
+
+    for (size_t count = 1000; count <= largest; count *= 10) {
+        std::vector<Employee> employees;
+        std::vector<Computer> computers;
+        bench::makeRecords(count, employees, computers);
+        DatabaseSnapshot records{ RecordTable<Employee>(std::move(employees)),
+                                  RecordTable<Computer>(std::move(computers)) };
+
+        std::vector<unsigned char> plain;
+        Serializer::serialize(records, [&plain](const unsigned char* data, size_t size) {
+            plain.insert(plain.end(), data, data + size);
+        });
+        storage.saveSnapshot(std::move(records), path, key);
+
+        int repeats = count < 1000000 ? 5 : 2;
+        size_t loaded = 0;
+        double sequentialMs = bench::bestOf(repeats, [&]() {
+            Database db = Serializer::deserialize(plain.data(), plain.size());
+            loaded = db.getEmployees().size() + db.getComputers().size();
+        });
+        double fileMs = bench::bestOf(repeats, [&]() {
+            Database db = storage.loadDatabase(path, password);
+            loaded = db.getEmployees().size() + db.getComputers().size();
+        });
+
+        if (loaded != count) {
+            std::cerr << "loaded " << loaded << " of " << count << " records\n";
+            return 1;
+        }
+
+        std::cout << count << " records (" << plain.size() / 1024 << " KB): "
+                  << "sequential decode " << sequentialMs << " ms, "
+                  << "loadDatabase (decrypt + parallel decode) " << fileMs << " ms\n";
+    }
+
+    std::remove(path.c_str());
+    return 0;
+}
@@ -0,0 +1,210 @@
+// Скорость кодирования записей: потоки iostream (исходный Serializer)
+// против буферного BinaryWriter/BinaryReader.
+//
+//   SerializerBenchmark [записей, по умолчанию 200000]
+
+#include "BenchmarkData.h"
+#include "storage/DatabaseFormat.h"
+#include "storage/Serializer.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+namespace {
+
+// Исходная реализация: ostringstream -> string -> vector при записи,
+// vector -> string -> istringstream при чтении
+namespace reference {
+
+void writeString(std::ostringstream& out, const std::string& value) {
+    size_t size = value.size();
+    out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    out.write(value.c_str(), size);
+}
+
+std::string readString(std::istringstream& in) {
+    size_t size;
+    in.read(reinterpret_cast<char*>(&size), sizeof(size));
+    std::string value(size, '\0');
+    in.read(&value[0], size);
+    return value;
+}
+
+template <typename T>
+void writeValue(std::ostringstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+void readValue(std::istringstream& in, T& value) {
+    in.read(reinterpret_cast<char*>(&value), sizeof(value));
+}
+
+std::vector<unsigned char> serialize(const std::vector<Employee>& employees,
+                                     const std::vector<Computer>& computers) {
+    std::ostringstream out(std::ios::binary);
+
+    writeValue(out, employees.size());
+    for (const auto& e : employees) {
+        writeValue(out, e.id);
+        writeString(out, e.institute);
+        writeString(out, e.department);
+        writeString(out, e.lastName);
+        writeString(out, e.initials);
+        writeString(out, e.position);
+        writeString(out, e.phone);
+        writeString(out, e.email);
+        writeString(out, e.employmentDate);
+        writeString(out, e.status);
+        bool hasComputer = e.computerId.has_value();
+        writeValue(out, hasComputer);
+        if (hasComputer)
+            writeValue(out, e.computerId.value());
+    }
+
+    writeValue(out, computers.size());
+    for (const auto& c : computers) {
+        writeValue(out, c.id);
+        writeString(out, c.inventoryNumber);
+        writeString(out, c.serialNumber);
+        writeString(out, c.manufacturer);
+        writeString(out, c.model);
+        writeString(out, c.cpuModel);
+        writeString(out, c.chipset);
+        writeValue(out, c.ramSize);
+        writeString(out, c.storageType);
+        writeValue(out, c.storageSize);
+        writeString(out, c.roomNumber);
+        writeString(out, c.condition);
+        writeString(out, c.commissioningDate);
+        writeString(out, c.lastMaintenanceDate);
+        writeString(out, c.warrantyExpirationDate);
+    }
+
+    std::string buffer = out.str();
+    return std::vector<unsigned char>(buffer.begin(), buffer.end());
+}
+
+void deserialize(const std::vector<unsigned char>& data,
+                 std::vector<Employee>& employees,
+                 std::vector<Computer>& computers) {
+    std::istringstream in(std::string(data.begin(), data.end()), std::ios::binary);
+
+    size_t count;
+    readValue(in, count);
+    for (size_t i = 0; i < count; ++i) {
+        Employee e;
+        readValue(in, e.id);
+        e.institute = readString(in);
+        e.department = readString(in);
+        e.lastName = readString(in);
+        e.initials = readString(in);
+        e.position = readString(in);
+        e.phone = readString(in);
+        e.email = readString(in);
+        e.employmentDate = readString(in);
+        e.status = readString(in);
+        bool hasComputer;
+        readValue(in, hasComputer);
+        if (hasComputer) {
+            int computerId;
+            readValue(in, computerId);
+            e.computerId = computerId;
+        }
+        employees.push_back(std::move(e));
+    }
+
+    readValue(in, count);
+    for (size_t i = 0; i < count; ++i) {
+        Computer c;
+        readValue(in, c.id);
+        c.inventoryNumber = readString(in);
+        c.serialNumber = readString(in);
+        c.manufacturer = readString(in);
+        c.model = readString(in);
+        c.cpuModel = readString(in);
+        c.chipset = readString(in);
+        readValue(in, c.ramSize);
+        c.storageType = readString(in);
+        readValue(in, c.storageSize);
+        c.roomNumber = readString(in);
+        c.condition = readString(in);
+        c.commissioningDate = readString(in);
+        c.lastMaintenanceDate = readString(in);
+        c.warrantyExpirationDate = readString(in);
+        computers.push_back(std::move(c));
+    }
+}
+
+}
+
+std::vector<unsigned char> serializeBuffered(const DatabaseSnapshot& records) {
+    std::vector<unsigned char> data;
+    Serializer::serialize(records, [&data](const unsigned char* bytes, size_t size) {
+        data.insert(data.end(), bytes, bytes + size);
+    });
+    return data;
+}
+
+// Блоки разделов декодируются подряд в одном потоке - сравнивается
+// только кодек, без параллельной загрузки
+void deserializeBuffered(const std::vector<unsigned char>& data,
+                         std::vector<Employee>& employees,
+                         std::vector<Computer>& computers) {
+    using namespace database_format;
+
+    Header header = readHeader(data.data(), data.size());
+    for (const auto& chunk : readChunks(data.data(), header, SectionId::Employees, SectionId::EmployeeChunks)) {
+        std::vector<Employee> part = Serializer::decodeEmployees(data.data(), chunk);
+        employees.insert(employees.end(), std::make_move_iterator(part.begin()), std::make_move_iterator(part.end()));
+    }
+    for (const auto& chunk : readChunks(data.data(), header, SectionId::Computers, SectionId::ComputerChunks)) {
+        std::vector<Computer> part = Serializer::decodeComputers(data.data(), chunk);
+        computers.insert(computers.end(), std::make_move_iterator(part.begin()), std::make_move_iterator(part.end()));
+    }
+}
+
+template <typename Serialize, typename Deserialize>
+void measure(const char* name, size_t expected, Serialize serialize, Deserialize deserialize) {
+    std::vector<unsigned char> data;
+    double writeMs = bench::bestOf(5, [&]() { data = serialize(); });
+
+    size_t decoded = 0;
+    double readMs = bench::bestOf(5, [&]() {
+        std::vector<Employee> employees;
+        std::vector<Computer> computers;
+        deserialize(data, employees, computers);
+        decoded = employees.size() + computers.size();
+    });
+
+    if (decoded != expected) {
+        std::cerr << name << ": decoded " << decoded << " of " << expected << " records\n";
+        std::exit(1);
+    }
+
+    std::cout << name << ": " << data.size() / (1024 * 1024) << " MB, "
+              << "write " << writeMs << " ms (" << bench::megabytesPerSecond(data.size(), writeMs) << " MB/s), "
+              << "read " << readMs << " ms (" << bench::megabytesPerSecond(data.size(), readMs) << " MB/s)\n";
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t count = bench::argument(argc, argv, 1, 200000);
+
+    std::vector<Employee> employees;
+    std::vector<Computer> computers;
+    bench::makeRecords(count, employees, computers);
+    DatabaseSnapshot records{ RecordTable<Employee>(employees), RecordTable<Computer>(computers) };
+
+    std::cout << count << " records\n";
+    measure("iostream", count,
+            [&]() { return reference::serialize(employees, computers); },
+            reference::deserialize);
+    measure("buffer  ", count,
+            [&]() { return serializeBuffered(records); },
+            deserializeBuffered);
+    return 0;
+}
@@ -1,81 +1,211 @@
 #include "ApplicationController.h"
+#include <chrono>
+#include <exception>
 #include <stdexcept>
 
+ApplicationController::~ApplicationController() {
+    settleAutosave();
+}
+
+void ApplicationController::markChanged() {
+    ++generation;
+}
+
+bool ApplicationController::appendsToJournal(const std::string& path) const {
+    return path == snapshot.path &&
+           !snapshot.baseId.empty() &&
+           !journal::needsCompaction(snapshot);
+}
+
+void ApplicationController::finishAutosave() {
+    std::exception_ptr error;
+    try {
+        snapshot = autosave.get();
+        savedGeneration = autosaveGeneration;
+    } catch (...) {
+        // Изменения снимка уже сняты с учета в базе, поэтому следующее
+        // сохранение записывает файл целиком
+        snapshot.baseId.clear();
+        error = std::current_exception();
+    }
+
+    autosaveChanges = ChangeSet();
+    if (error)
+        std::rethrow_exception(error);
+}
+
+// Перед явным сохранением и сменой базы фоновая запись доводится до конца;
+// ее ошибка не прерывает операцию - после сбоя сохранение будет полным
+void ApplicationController::settleAutosave() {
+    try {
+        waitForAutosave();
+    } catch (const std::exception&) {
+    }
+}
+
 void ApplicationController::createNewDatabase(const std::string& password) {
+    settleAutosave();
+    currentKey = CryptoService::deriveKey(password, CryptoService::makeKdfParams());
     database = Database();
-    currentPassword = password;
+    snapshot = SnapshotInfo();
     loaded = true;
-    dirty = true;
+    savedGeneration = generation;
+    markChanged();
 }
 
 void ApplicationController::loadDatabase(const std::string& path,
                                          const std::string& password) {
-    database = storage.loadDatabase(path, password);
-    currentPassword = password;
+    settleAutosave();
+
+    CryptoKey key;
+    SnapshotInfo loadedSnapshot;
+    database = storage.loadDatabase(path, password, key, loadedSnapshot);
+    snapshot = std::move(loadedSnapshot);
+
+    // Файлы без соли при следующем сохранении переводятся на PBKDF2
+    if (key.params.iterations == 0)
+        key = CryptoService::deriveKey(password, CryptoService::makeKdfParams());
+    currentKey = std::move(key);
     loaded = true;
-    dirty = false;
+    savedGeneration = generation;
 }
 
 void ApplicationController::saveDatabase(const std::string& path) {
     if (!loaded)
         throw std::runtime_error("База не загружена");
 
-    database.validate();
-    storage.saveDatabase(database, path, currentPassword);
-    dirty = false;
+    settleAutosave();
+
+    // Проверяются только записи, измененные после прошлой проверки
+    database.validateChanges();
+
+    if (appendsToJournal(path)) {
+        if (database.hasChanges())
+            storage.appendJournal(database.collectChanges(), currentKey, snapshot);
+    } else {
+        snapshot = storage.saveSnapshot(database.snapshot(), path, currentKey);
+    }
+
+    database.clearChanges();
+    savedGeneration = generation;
+}
+
+bool ApplicationController::startAutosave() {
+    if (!pollAutosave())
+        return false;
+
+    if (!loaded || snapshot.path.empty() || !isDirty())
+        return false;
+
+    database.validateChanges();
+
+    // Фоновая задача получает копии ключа и сведений о файле; записи
+    // берутся из снимка, который не меняется, пока база редактируется
+    SnapshotInfo target = snapshot;
+    CryptoKey key = currentKey;
+
+    if (appendsToJournal(target.path)) {
+        autosaveChanges = database.collectChanges();
+        autosave = std::async(std::launch::async, [this, target, key]() mutable {
+            storage.appendJournal(autosaveChanges, key, target);
+            return target;
+        });
+    } else {
+        // Правка записи, пока снимок жив, копирует ее блок в потоке UI
+        // (RecordTable::writable), поэтому задача владеет снимком
+        // и отпускает его, как только записи сериализованы
+        autosave = std::async(std::launch::async,
+                              [this, target, key, records = database.snapshot()]() mutable {
+            return storage.saveSnapshot(std::move(records), target.path, key);
+        });
+    }
+
+    // Изменения, сделанные во время записи, копятся заново и относятся
+    // к следующему поколению
+    database.clearChanges();
+    autosaveGeneration = generation;
+    return true;
+}
+
+bool ApplicationController::pollAutosave() {
+    if (!autosave.valid())
+        return true;
+
+    if (autosave.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return false;
+
+    finishAutosave();
+    return true;
+}
+
+void ApplicationController::waitForAutosave() {
+    if (!autosave.valid())
+        return;
+
+    autosave.wait();
+    finishAutosave();
 }
 
 int ApplicationController::addEmployee(const Employee& e) {
     int id = database.addEmployee(e);
-    dirty = true;
+    if (id != 0)
+        markChanged();
     return id;
 }
 
 int ApplicationController::addComputer(const Computer& c) {
     int id = database.addComputer(c);
-    dirty = true;
+    markChanged();
     return id;
 }
 
 bool ApplicationController::assignComputer(int empId, int compId) {
     bool result = database.assignComputer(empId, compId);
     if (result)
-        dirty = true;
+        markChanged();
     return result;
 }
 
 void ApplicationController::removeEmployee(int id) {
     database.removeEmployee(id);
-    dirty = true;
+    markChanged();
 }
 
 void ApplicationController::removeComputer(int id) {
     database.removeComputer(id);
-    dirty = true;
+    markChanged();
 }
 
 bool ApplicationController::updateEmployee(const Employee& e) {
     bool result = database.updateEmployee(e);
     if (result)
-        dirty = true;
+        markChanged();
     return result;
 }
 
 bool ApplicationController::updateComputer(const Computer& c) {
     bool result = database.updateComputer(c);
     if (result)
-        dirty = true;
+        markChanged();
     return result;
 }
 
-const std::vector<Employee>& ApplicationController::getEmployees() const {
+const RecordTable<Employee>& ApplicationController::getEmployees() const {
     return database.getEmployees();
 }
 
-const std::vector<Computer>& ApplicationController::getComputers() const {
+const RecordTable<Computer>& ApplicationController::getComputers() const {
     return database.getComputers();
 }
 
+const Employee* ApplicationController::findEmployeeById(int id) const {
+    return database.findEmployeeById(id);
+}
+
+const Computer* ApplicationController::findComputerById(int id) const {
+    return database.findComputerById(id);
+}
+
 std::vector<Computer> ApplicationController::getReportRamLessThan(int value) const {
     return database.getComputersWithRamLessThan(value);
 }
@@ -84,6 +214,32 @@ std::vector<Computer> ApplicationController::getFreeComputers() const {
     return database.getFreeComputers();
 }
 
+column_scan::Selection ApplicationController::selectComputers(const std::vector<ComputerRange>& ranges,
+                                                             const std::vector<ComputerCategoryFilter>& categories) const {
+    return database.selectComputers(ranges, categories);
+}
+
+std::vector<int> ApplicationController::findComputerIdsInRange(const ComputerRange& range,
+                                                               const column_scan::Selection& within) const {
+    return database.findComputerIdsInRange(range, within);
+}
+
+RoaringBitmap ApplicationController::selectEmployeeIds(const std::vector<EmployeeCategoryFilter>& filters) const {
+    return database.selectEmployeeIds(filters);
+}
+
+std::vector<InternedString> ApplicationController::categoryValues(EmployeeCategory category) const {
+    return database.categoryValues(category);
+}
+
+std::vector<InternedString> ApplicationController::categoryValues(ComputerCategory category) const {
+    return database.categoryValues(category);
+}
+
+const Employee* ApplicationController::ownerOf(int computerId) const {
+    return database.ownerOf(computerId);
+}
+
 bool ApplicationController::isInventoryNumberUnique(const std::string& inventoryNumber) const {
     return database.isInventoryNumberUnique(inventoryNumber);
 }
@@ -95,7 +251,7 @@ bool ApplicationController::isSerialNumberUnique(const std::string& serialNumber
 bool ApplicationController::unassignComputerByComputerId(int computerId) {
     bool result = database.unassignComputerByComputerId(computerId);
     if (result)
-        dirty = true;
+        markChanged();
     return result;
 }
 
@@ -104,5 +260,5 @@ bool ApplicationController::isLoaded() const {
 }
 
 bool ApplicationController::isDirty() const {
-    return dirty;
+    return generation != savedGeneration;
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <future>
 #include <string>
 #include <vector>
 
@@ -13,16 +15,49 @@ class ApplicationController
 private:
     Database database;
     StorageService storage;
-    std::string currentPassword;
+    // Ключ текущего файла: KDF выполняется только при создании и загрузке
+    CryptoKey currentKey;
+    // Последнее полное сохранение; пока файл тот же, изменения дописываются в журнал
+    SnapshotInfo snapshot;
     bool loaded = false;
-    bool dirty = false;
+
+    // Поколение растет с каждым изменением; база не изменена, пока
+    // сохранено последнее поколение
+    uint64_t generation = 0;
+    uint64_t savedGeneration = 0;
+
+    // Фоновое автосохранение. Снимок записей принадлежит задаче и отпускается
+    // сразу после сериализации; изменения для журнала живут до завершения записи
+    std::future<SnapshotInfo> autosave;
+    ChangeSet autosaveChanges;
+    uint64_t autosaveGeneration = 0;
+
+    void markChanged();
+    bool appendsToJournal(const std::string& path) const;
+    void finishAutosave();
+    void settleAutosave();
 
 public:
+    ApplicationController() = default;
+    ~ApplicationController();
+
+    ApplicationController(const ApplicationController&) = delete;
+    ApplicationController& operator=(const ApplicationController&) = delete;
+
     void createNewDatabase(const std::string& password);
     void loadDatabase(const std::string& path,
                       const std::string& password);
     void saveDatabase(const std::string& path);
 
+    // Автосохранение в текущий файл: снимок базы берется сразу, а запись
+    // идет в фоновом потоке, пока пользователь продолжает работу.
+    // false - сохранять нечего, файл еще не выбран или запись уже идет.
+    bool startAutosave();
+    // Забирает результат завершившейся фоновой записи (ошибка записи
+    // пробрасывается здесь); false - запись еще идет
+    bool pollAutosave();
+    void waitForAutosave();
+
     int addEmployee(const Employee& e);
     int addComputer(const Computer& c);
 
@@ -33,11 +68,21 @@ public:
     bool updateEmployee(const Employee& e);
     bool updateComputer(const Computer& c);
 
-    const std::vector<Employee>& getEmployees() const;
-    const std::vector<Computer>& getComputers() const;
+    const RecordTable<Employee>& getEmployees() const;
+    const RecordTable<Computer>& getComputers() const;
+    const Employee* findEmployeeById(int id) const;
+    const Computer* findComputerById(int id) const;
 
     std::vector<Computer> getReportRamLessThan(int value) const;
     std::vector<Computer> getFreeComputers() const;
+    column_scan::Selection selectComputers(const std::vector<ComputerRange>& ranges,
+                                           const std::vector<ComputerCategoryFilter>& categories = {}) const;
+    std::vector<int> findComputerIdsInRange(const ComputerRange& range,
+                                            const column_scan::Selection& within) const;
+    RoaringBitmap selectEmployeeIds(const std::vector<EmployeeCategoryFilter>& filters) const;
+    std::vector<InternedString> categoryValues(EmployeeCategory category) const;
+    std::vector<InternedString> categoryValues(ComputerCategory category) const;
+    const Employee* ownerOf(int computerId) const;
     bool isInventoryNumberUnique(const std::string& inventoryNumber) const;
     bool isSerialNumberUnique(const std::string& serialNumber) const;
     bool unassignComputerByComputerId(int computerId);
@@ -0,0 +1,18 @@
+#pragma once
+#include <vector>
+#include "../models/Employee.h"
+#include "../models/Computer.h"
+
+// Изменения записей с момента последнего сохранения: актуальные версии
+// добавленных и измененных записей (по возрастанию ID) и ID удаленных
+struct ChangeSet {
+    std::vector<Employee> employees;
+    std::vector<int> removedEmployeeIds;
+    std::vector<Computer> computers;
+    std::vector<int> removedComputerIds;
+
+    bool empty() const {
+        return employees.empty() && removedEmployeeIds.empty() &&
+               computers.empty() && removedComputerIds.empty();
+    }
+};
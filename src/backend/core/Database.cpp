@@ -1,13 +1,204 @@
 #include "Database.h"
 #include <algorithm>
+#include <climits>
+#include <iterator>
 #include <sstream>
 #include <stdexcept>
 #include <unordered_set>
+#include <utility>
 #include "../utils/DateUtils.h"
+#include "../utils/ThreadPool.h"
+
+void Database::reindexEmployeesFrom(size_t slot) {
+    for (size_t i = slot; i < employees.size(); ++i)
+        employeeIndex[employees[i].id] = i;
+}
+
+void Database::reindexComputersFrom(size_t slot) {
+    for (size_t i = slot; i < computers.size(); ++i)
+        computerIndex[computers[i].id] = i;
+}
+
+void Database::indexComputerKeys(const Computer& computer) {
+    inventoryIndex.emplace(computer.inventoryNumber, computer.id);
+    serialIndex.emplace(computer.serialNumber, computer.id);
+}
+
+void Database::unindexComputerKeys(const Computer& computer) {
+    auto inv = inventoryIndex.find(computer.inventoryNumber);
+    if (inv != inventoryIndex.end() && inv->second == computer.id)
+        inventoryIndex.erase(inv);
+
+    auto serial = serialIndex.find(computer.serialNumber);
+    if (serial != serialIndex.end() && serial->second == computer.id)
+        serialIndex.erase(serial);
+}
+
+void Database::claimComputer(const Employee& employee) {
+    if (!employee.computerId.has_value())
+        return;
+
+    computerOwners.emplace(employee.computerId.value(), employee.id);
+    markAssigned(employee.computerId.value(), true);
+}
+
+void Database::releaseComputer(const Employee& employee) {
+    if (!employee.computerId.has_value())
+        return;
+
+    auto it = computerOwners.find(employee.computerId.value());
+    if (it != computerOwners.end() && it->second == employee.id) {
+        computerOwners.erase(it);
+        markAssigned(employee.computerId.value(), false);
+    }
+}
+
+// До построения computerIndex (в bulkLoad) отметки не ставятся:
+// столбцы заполняются целиком в rebuildScanTables
+void Database::markAssigned(int computerId, bool assigned) {
+    auto it = computerIndex.find(computerId);
+    if (it != computerIndex.end() && it->second < assignedColumn.size())
+        assignedColumn[it->second] = assigned ? 1 : 0;
+}
+
+static const InternedString& categoryField(const Employee& e, EmployeeCategory category) {
+    switch (category) {
+    case EmployeeCategory::Institute:
+        return e.institute;
+    case EmployeeCategory::Department:
+        return e.department;
+    case EmployeeCategory::Status:
+        return e.status;
+    }
+    throw std::invalid_argument("Неизвестное поле сотрудника");
+}
+
+static const InternedString& categoryField(const Computer& c, ComputerCategory category) {
+    switch (category) {
+    case ComputerCategory::Manufacturer:
+        return c.manufacturer;
+    case ComputerCategory::StorageType:
+        return c.storageType;
+    case ComputerCategory::RoomNumber:
+        return c.roomNumber;
+    case ComputerCategory::Condition:
+        return c.condition;
+    }
+    throw std::invalid_argument("Неизвестное поле компьютера");
+}
+
+// Карты хранятся только для встречающихся значений: опустевшая удаляется
+template <typename Category, typename Index, typename Record>
+static void updateCategories(Index& indexes, const Record& record, bool present) {
+    for (size_t i = 0; i < indexes.size(); ++i) {
+        const InternedString& value = categoryField(record, static_cast<Category>(i));
+        if (present) {
+            indexes[i][value].add(static_cast<uint32_t>(record.id));
+            continue;
+        }
+
+        auto it = indexes[i].find(value);
+        if (it == indexes[i].end())
+            continue;
+        it->second.remove(static_cast<uint32_t>(record.id));
+        if (it->second.empty())
+            indexes[i].erase(it);
+    }
+}
+
+void Database::indexCategories(const Employee& employee) {
+    updateCategories<EmployeeCategory>(employeeCategories, employee, true);
+}
+
+void Database::indexCategories(const Computer& computer) {
+    updateCategories<ComputerCategory>(computerCategories, computer, true);
+}
+
+void Database::unindexCategories(const Employee& employee) {
+    updateCategories<EmployeeCategory>(employeeCategories, employee, false);
+}
+
+void Database::unindexCategories(const Computer& computer) {
+    updateCategories<ComputerCategory>(computerCategories, computer, false);
+}
+
+void Database::appendComputerColumns(const Computer& computer) {
+    ramColumn.push_back(computer.ramSize);
+    storageColumn.push_back(computer.storageSize);
+    maintenanceColumn.push_back(computer.lastMaintenanceDay);
+    warrantyColumn.push_back(computer.warrantyExpirationDay);
+    assignedColumn.push_back(isComputerAssigned(computer.id) ? 1 : 0);
+
+    ramOrder.emplace(computer.ramSize, computer.id);
+    storageOrder.emplace(computer.storageSize, computer.id);
+    maintenanceOrder.emplace(computer.lastMaintenanceDay, computer.id);
+    warrantyOrder.emplace(computer.warrantyExpirationDay, computer.id);
+}
+
+// Значение в столбце заменяется вместе с его ключом в индексе
+static void replaceIndexed(std::vector<int32_t>& column,
+                           std::set<std::pair<int32_t, int>>& index,
+                           size_t slot, int id, int32_t value) {
+    if (column[slot] == value)
+        return;
+    index.erase({ column[slot], id });
+    index.emplace(value, id);
+    column[slot] = value;
+}
+
+void Database::assignComputerColumns(size_t slot, const Computer& computer) {
+    replaceIndexed(ramColumn, ramOrder, slot, computer.id, computer.ramSize);
+    replaceIndexed(storageColumn, storageOrder, slot, computer.id, computer.storageSize);
+    replaceIndexed(maintenanceColumn, maintenanceOrder, slot, computer.id, computer.lastMaintenanceDay);
+    replaceIndexed(warrantyColumn, warrantyOrder, slot, computer.id, computer.warrantyExpirationDay);
+}
+
+void Database::eraseComputerColumns(size_t slot, int id) {
+    ramOrder.erase({ ramColumn[slot], id });
+    storageOrder.erase({ storageColumn[slot], id });
+    maintenanceOrder.erase({ maintenanceColumn[slot], id });
+    warrantyOrder.erase({ warrantyColumn[slot], id });
+
+    ramColumn.erase(ramColumn.begin() + slot);
+    storageColumn.erase(storageColumn.begin() + slot);
+    maintenanceColumn.erase(maintenanceColumn.begin() + slot);
+    warrantyColumn.erase(warrantyColumn.begin() + slot);
+    assignedColumn.erase(assignedColumn.begin() + slot);
+}
+
+// Даты разбираются один раз, когда запись попадает в базу
+static void parseDates(Employee& e) {
+    e.employmentDay = date_utils::toDayNumber(e.employmentDate);
+}
+
+static void parseDates(Computer& c) {
+    c.commissioningDay = date_utils::toDayNumber(c.commissioningDate);
+    c.lastMaintenanceDay = date_utils::toDayNumber(c.lastMaintenanceDate);
+    c.warrantyExpirationDay = date_utils::toDayNumber(c.warrantyExpirationDate);
+}
+
+void Database::touchEmployee(int id) {
+    changedEmployeeIds.insert(id);
+    uncheckedEmployeeIds.insert(id);
+}
+
+void Database::touchComputer(int id) {
+    changedComputerIds.insert(id);
+    uncheckedComputerIds.insert(id);
+}
 
 int Database::addEmployee(Employee employee) {
+    if (employee.computerId.has_value() && isComputerAssigned(employee.computerId.value()))
+        return 0;
+
     employee.id = nextEmployeeId++;
+    parseDates(employee);
     employees.push_back(employee);
+    employeeText.append(employee.id, { employee.lastName });
+    indexCategories(employees.back());
+    employeeIndex[employee.id] = employees.size() - 1;
+    claimComputer(employee);
+    touchEmployee(employee.id);
     return employee.id;
 }
 
@@ -17,7 +208,14 @@ int Database::addComputer(Computer computer) {
     if (!isSerialNumberUnique(computer.serialNumber))
         throw std::runtime_error("Серийный номер уже существует: " + computer.serialNumber);
     computer.id = nextComputerId++;
+    parseDates(computer);
     computers.push_back(computer);
+    computerText.append(computer.id, { computer.inventoryNumber });
+    appendComputerColumns(computers.back());
+    indexCategories(computers.back());
+    computerIndex[computer.id] = computers.size() - 1;
+    indexComputerKeys(computer);
+    touchComputer(computer.id);
     return computer.id;
 }
 
@@ -25,12 +223,17 @@ int Database::addEmployeeWithId(const Employee& employee) {
     if (employee.id <= 0)
         throw std::runtime_error("Некорректный ID сотрудника при загрузке");
 
-    for (const auto& e : employees) {
-        if (e.id == employee.id)
-            throw std::runtime_error("Дублируется ID сотрудника при загрузке: " + std::to_string(employee.id));
-    }
+    if (employeeIndex.count(employee.id))
+        throw std::runtime_error("Дублируется ID сотрудника при загрузке: " + std::to_string(employee.id));
 
-    employees.push_back(employee);
+    Employee added = employee;
+    parseDates(added);
+    employees.push_back(added);
+    employeeText.append(employee.id, { employee.lastName });
+    indexCategories(employees.back());
+    employeeIndex[employee.id] = employees.size() - 1;
+    claimComputer(employee);
+    touchEmployee(employee.id);
 
     if (employee.id >= nextEmployeeId)
         nextEmployeeId = employee.id + 1;
@@ -42,12 +245,18 @@ int Database::addComputerWithId(const Computer& computer) {
     if (computer.id <= 0)
         throw std::runtime_error("Некорректный ID компьютера при загрузке");
 
-    for (const auto& c : computers) {
-        if (c.id == computer.id)
-            throw std::runtime_error("Дублируется ID компьютера при загрузке: " + std::to_string(computer.id));
-    }
+    if (computerIndex.count(computer.id))
+        throw std::runtime_error("Дублируется ID компьютера при загрузке: " + std::to_string(computer.id));
 
-    computers.push_back(computer);
+    Computer added = computer;
+    parseDates(added);
+    computers.push_back(added);
+    computerText.append(computer.id, { computer.inventoryNumber });
+    appendComputerColumns(computers.back());
+    indexCategories(computers.back());
+    computerIndex[computer.id] = computers.size() - 1;
+    indexComputerKeys(computer);
+    touchComputer(computer.id);
 
     if (computer.id >= nextComputerId)
         nextComputerId = computer.id + 1;
@@ -55,102 +264,314 @@ int Database::addComputerWithId(const Computer& computer) {
     return computer.id;
 }
 
-void Database::removeEmployee(int id) {
-    employees.erase(
-        std::remove_if(employees.begin(), employees.end(),
-            [id](const Employee& e) { return e.id == id; }),
-        employees.end()
-    );
+void Database::bulkLoad(std::vector<Employee> loadedEmployees,
+                        std::vector<Computer> loadedComputers) {
+    Database loaded;
+    loaded.uncheckedAll = true;
+    std::vector<Employee>& employeeRecords = loadedEmployees;
+    std::vector<Computer>& computerRecords = loadedComputers;
+    loaded.employeeIndex.reserve(employeeRecords.size());
+    loaded.computerIndex.reserve(computerRecords.size());
+    loaded.inventoryIndex.reserve(computerRecords.size());
+    loaded.serialIndex.reserve(computerRecords.size());
+    loaded.computerOwners.reserve(employeeRecords.size());
+
+    date_utils::parseDateColumn(employeeRecords, &Employee::employmentDate, &Employee::employmentDay);
+    date_utils::parseDateColumn(computerRecords, &Computer::commissioningDate, &Computer::commissioningDay);
+    date_utils::parseDateColumn(computerRecords, &Computer::lastMaintenanceDate, &Computer::lastMaintenanceDay);
+    date_utils::parseDateColumn(computerRecords, &Computer::warrantyExpirationDate, &Computer::warrantyExpirationDay);
+
+    for (size_t i = 0; i < employeeRecords.size(); ++i) {
+        const Employee& e = employeeRecords[i];
+        if (e.id <= 0)
+            throw std::runtime_error("Некорректный ID сотрудника при загрузке");
+        if (!loaded.employeeIndex.emplace(e.id, i).second)
+            throw std::runtime_error("Дублируется ID сотрудника при загрузке: " + std::to_string(e.id));
+        if (e.id >= loaded.nextEmployeeId)
+            loaded.nextEmployeeId = e.id + 1;
+        loaded.claimComputer(e);
+    }
+
+    for (size_t i = 0; i < computerRecords.size(); ++i) {
+        const Computer& c = computerRecords[i];
+        if (c.id <= 0)
+            throw std::runtime_error("Некорректный ID компьютера при загрузке");
+        if (!loaded.computerIndex.emplace(c.id, i).second)
+            throw std::runtime_error("Дублируется ID компьютера при загрузке: " + std::to_string(c.id));
+        if (c.id >= loaded.nextComputerId)
+            loaded.nextComputerId = c.id + 1;
+        loaded.indexComputerKeys(c);
+    }
+
+    loaded.employees = RecordTable<Employee>(std::move(employeeRecords));
+    loaded.computers = RecordTable<Computer>(std::move(computerRecords));
+    loaded.rebuildScanTables();
+    *this = std::move(loaded);
 }
 
-void Database::removeComputer(int id) {
+// Применяет к записям изменения по порядку; удаленные записи помечаются
+// и вычищаются одним проходом в конце, чтобы сохранить порядок остальных
+template <typename Record>
+static std::vector<Record> applyRecordChanges(std::vector<Record> records,
+                                              const std::vector<ChangeSet>& changeSets,
+                                              const std::vector<Record> ChangeSet::* changed,
+                                              const std::vector<int> ChangeSet::* removed) {
+    std::unordered_map<int, size_t> slots;
+    slots.reserve(records.size());
+    for (size_t i = 0; i < records.size(); ++i)
+        slots.emplace(records[i].id, i);
+
+    std::vector<bool> erased(records.size(), false);
+
+    for (const auto& changes : changeSets) {
+        for (int id : changes.*removed) {
+            auto it = slots.find(id);
+            if (it != slots.end()) {
+                erased[it->second] = true;
+                slots.erase(it);
+            }
+        }
 
-    for (auto& e : employees) {
-        if (e.computerId.has_value() && e.computerId.value() == id) {
-            e.computerId.reset();
+        for (const Record& record : changes.*changed) {
+            auto it = slots.find(record.id);
+            if (it != slots.end()) {
+                records[it->second] = record;
+            } else {
+                slots.emplace(record.id, records.size());
+                records.push_back(record);
+                erased.push_back(false);
+            }
         }
     }
 
-    computers.erase(
-        std::remove_if(computers.begin(), computers.end(),
-            [id](const Computer& c) { return c.id == id; }),
-        computers.end()
-    );
+    size_t kept = 0;
+    for (size_t i = 0; i < records.size(); ++i) {
+        if (!erased[i]) {
+            if (kept != i)
+                records[kept] = std::move(records[i]);
+            ++kept;
+        }
+    }
+    records.resize(kept);
+    return records;
 }
 
-bool Database::updateEmployee(const Employee& employee) {
-    for (auto& e : employees) {
-        if (e.id == employee.id) {
-            e = employee;
-            return true;
-        }
+void Database::applyChanges(const std::vector<ChangeSet>& changeSets) {
+    if (changeSets.empty())
+        return;
+
+    // Если база до этого была проверена, после применения достаточно
+    // проверить записи из журнала
+    bool checked = !uncheckedAll;
+    std::unordered_set<int> employeeIds = std::move(uncheckedEmployeeIds);
+    std::unordered_set<int> computerIds = std::move(uncheckedComputerIds);
+
+    bulkLoad(applyRecordChanges(std::vector<Employee>(employees.begin(), employees.end()), changeSets,
+                                &ChangeSet::employees, &ChangeSet::removedEmployeeIds),
+             applyRecordChanges(std::vector<Computer>(computers.begin(), computers.end()), changeSets,
+                                &ChangeSet::computers, &ChangeSet::removedComputerIds));
+
+    if (!checked)
+        return;
+
+    for (const auto& changes : changeSets) {
+        for (const auto& e : changes.employees)
+            employeeIds.insert(e.id);
+        employeeIds.insert(changes.removedEmployeeIds.begin(), changes.removedEmployeeIds.end());
+        for (const auto& c : changes.computers)
+            computerIds.insert(c.id);
+        computerIds.insert(changes.removedComputerIds.begin(), changes.removedComputerIds.end());
     }
-    return false;
+
+    // Номер из журнала может совпасть с номером записи, которой в журнале
+    // нет, и индекс тогда указывает на любую из двух. Поэтому с полными
+    // индексами сверяются все компьютеры: повторный номер попадает
+    // в проверку у той записи, что не вошла в индекс
+    for (const Computer& c : computers) {
+        if (inventoryIndex.at(c.inventoryNumber) != c.id || serialIndex.at(c.serialNumber) != c.id)
+            computerIds.insert(c.id);
+    }
+
+    uncheckedEmployeeIds = std::move(employeeIds);
+    uncheckedComputerIds = std::move(computerIds);
+    uncheckedAll = false;
 }
 
-bool Database::updateComputer(const Computer& computer) {
-    for (const auto& c : computers) {
-        if (c.id == computer.id)
-            continue;
-        if (c.inventoryNumber == computer.inventoryNumber)
-            throw std::runtime_error("Инвентарный номер уже существует: " + computer.inventoryNumber);
-        if (c.serialNumber == computer.serialNumber)
-            throw std::runtime_error("Серийный номер уже существует: " + computer.serialNumber);
+bool Database::hasChanges() const {
+    return !changedEmployeeIds.empty() || !changedComputerIds.empty();
+}
+
+ChangeSet Database::collectChanges() const {
+    ChangeSet changes;
+
+    std::vector<int> employeeIds(changedEmployeeIds.begin(), changedEmployeeIds.end());
+    std::sort(employeeIds.begin(), employeeIds.end());
+    for (int id : employeeIds) {
+        if (const Employee* e = findEmployeeById(id))
+            changes.employees.push_back(*e);
+        else
+            changes.removedEmployeeIds.push_back(id);
     }
 
-    for (auto& c : computers) {
-        if (c.id == computer.id) {
-            c = computer;
-            return true;
-        }
+    std::vector<int> computerIds(changedComputerIds.begin(), changedComputerIds.end());
+    std::sort(computerIds.begin(), computerIds.end());
+    for (int id : computerIds) {
+        if (const Computer* c = findComputerById(id))
+            changes.computers.push_back(*c);
+        else
+            changes.removedComputerIds.push_back(id);
     }
-    return false;
+
+    return changes;
 }
 
+void Database::clearChanges() {
+    changedEmployeeIds.clear();
+    changedComputerIds.clear();
+}
+
+DatabaseSnapshot Database::snapshot() const {
+    return DatabaseSnapshot{ employees, computers };
+}
+
+void Database::removeEmployee(int id) {
+    auto it = employeeIndex.find(id);
+    if (it == employeeIndex.end())
+        return;
+
+    size_t slot = it->second;
+    employeeIndex.erase(it);
+    releaseComputer(employees[slot]);
+    unindexCategories(employees[slot]);
+    employees.erase(slot);
+    employeeText.erase(slot);
+    reindexEmployeesFrom(slot);
+    touchEmployee(id);
+}
+
+void Database::removeComputer(int id) {
+    unassignComputerByComputerId(id);
+
+    auto it = computerIndex.find(id);
+    if (it == computerIndex.end())
+        return;
+
+    size_t slot = it->second;
+    computerIndex.erase(it);
+    unindexComputerKeys(computers[slot]);
+    unindexCategories(computers[slot]);
+    computers.erase(slot);
+    computerText.erase(slot);
+    eraseComputerColumns(slot, id);
+    reindexComputersFrom(slot);
+    touchComputer(id);
+}
+
+bool Database::updateEmployee(const Employee& employee) {
+    Employee* e = findEmployeeById(employee.id);
+    if (!e)
+        return false;
+
+    if (employee.computerId.has_value()) {
+        auto owner = computerOwners.find(employee.computerId.value());
+        if (owner != computerOwners.end() && owner->second != employee.id)
+            return false;
+    }
+
+    releaseComputer(*e);
+    unindexCategories(*e);
+    *e = employee;
+    parseDates(*e);
+    employeeText.assign(employeeIndex.at(employee.id), employee.id, { employee.lastName });
+    claimComputer(*e);
+    indexCategories(*e);
+    touchEmployee(employee.id);
+    return true;
+}
+
+bool Database::updateComputer(const Computer& computer) {
+    auto inv = inventoryIndex.find(computer.inventoryNumber);
+    if (inv != inventoryIndex.end() && inv->second != computer.id)
+        throw std::runtime_error("Инвентарный номер уже существует: " + computer.inventoryNumber);
+
+    auto serial = serialIndex.find(computer.serialNumber);
+    if (serial != serialIndex.end() && serial->second != computer.id)
+        throw std::runtime_error("Серийный номер уже существует: " + computer.serialNumber);
+
+    Computer* c = findComputerById(computer.id);
+    if (!c)
+        return false;
+
+    unindexComputerKeys(*c);
+    unindexCategories(*c);
+    *c = computer;
+    parseDates(*c);
+    size_t slot = computerIndex.at(computer.id);
+    computerText.assign(slot, computer.id, { computer.inventoryNumber });
+    assignComputerColumns(slot, *c);
+    indexComputerKeys(*c);
+    indexCategories(*c);
+    touchComputer(computer.id);
+    return true;
+}
+
+// Изменяемый доступ отделяет блок записи от снимков, поэтому без изменения
+// записи используются константные версии поиска
 Employee* Database::findEmployeeById(int id) {
-    for (auto& e : employees)
-        if (e.id == id)
-            return &e;
-    return nullptr;
+    auto it = employeeIndex.find(id);
+    return it != employeeIndex.end() ? &employees.writable(it->second) : nullptr;
 }
 
 Computer* Database::findComputerById(int id) {
-    for (auto& c : computers)
-        if (c.id == id)
-            return &c;
-    return nullptr;
+    auto it = computerIndex.find(id);
+    return it != computerIndex.end() ? &computers.writable(it->second) : nullptr;
+}
+
+const Employee* Database::findEmployeeById(int id) const {
+    auto it = employeeIndex.find(id);
+    return it != employeeIndex.end() ? &employees[it->second] : nullptr;
+}
+
+const Computer* Database::findComputerById(int id) const {
+    auto it = computerIndex.find(id);
+    return it != computerIndex.end() ? &computers[it->second] : nullptr;
 }
 
 bool Database::isInventoryNumberUnique(const std::string& inventoryNumber) const {
-    for (const auto& c : computers)
-        if (c.inventoryNumber == inventoryNumber)
-            return false;
-    return true;
+    return inventoryIndex.find(inventoryNumber) == inventoryIndex.end();
 }
 
 bool Database::isSerialNumberUnique(const std::string& serialNumber) const {
-    for (const auto& c : computers)
-        if (c.serialNumber == serialNumber)
-            return false;
-    return true;
+    return serialIndex.find(serialNumber) == serialIndex.end();
+}
+
+const Computer* Database::findComputerByInventoryNumber(const std::string& inventoryNumber) const {
+    auto it = inventoryIndex.find(inventoryNumber);
+    return it != inventoryIndex.end() ? findComputerById(it->second) : nullptr;
+}
+
+const Computer* Database::findComputerBySerialNumber(const std::string& serialNumber) const {
+    auto it = serialIndex.find(serialNumber);
+    return it != serialIndex.end() ? findComputerById(it->second) : nullptr;
 }
 
 bool Database::assignComputer(int employeeId, int computerId) {
-    Employee* employee = findEmployeeById(employeeId);
-    Computer* computer = findComputerById(computerId);
+    const Employee* current = std::as_const(*this).findEmployeeById(employeeId);
+    if (!current || !computerIndex.count(computerId))
+        return false;
 
-    if (!employee || !computer)
+    static const InternedString kDismissed("Уволен");
+    if (current->status == kDismissed)
         return false;
 
-    if (employee->status == "Уволен")
+    if (isComputerAssigned(computerId))
         return false;
 
-    for (const auto& e : employees) {
-        if (e.computerId.has_value() &&
-            e.computerId.value() == computerId)
-            return false;
-    }
+    Employee* employee = findEmployeeById(employeeId);
+    releaseComputer(*employee);
     employee->computerId = computerId;
+    claimComputer(*employee);
+    touchEmployee(employeeId);
     return true;
 }
 
@@ -159,71 +580,204 @@ bool Database::unassignComputer(int employeeId) {
     if (!employee)
         return false;
 
+    releaseComputer(*employee);
     employee->computerId.reset();
+    touchEmployee(employeeId);
     return true;
 }
 
 bool Database::unassignComputerByComputerId(int computerId) {
-    for (auto& e : employees) {
-        if (e.computerId.has_value() &&
-            e.computerId.value() == computerId) {
-            e.computerId.reset();
-            return true;
-        }
+    auto it = computerOwners.find(computerId);
+    if (it == computerOwners.end())
+        return false;
+
+    Employee* owner = findEmployeeById(it->second);
+    computerOwners.erase(it);
+    markAssigned(computerId, false);
+    if (owner) {
+        owner->computerId.reset();
+        touchEmployee(owner->id);
     }
-    return false;
+    return true;
 }
 
-std::vector<Computer> Database::getFreeComputers() const {
-
-    std::vector<Computer> freeComputers;
+const Employee* Database::ownerOf(int computerId) const {
+    auto it = computerOwners.find(computerId);
+    return it != computerOwners.end() ? findEmployeeById(it->second) : nullptr;
+}
 
-    for (const auto& computer : computers) {
+bool Database::isComputerAssigned(int computerId) const {
+    return computerOwners.find(computerId) != computerOwners.end();
+}
 
-        bool assigned = false;
+std::vector<Computer> Database::getFreeComputers() const {
 
-        for (const auto& employee : employees) {
-            if (employee.computerId.has_value() &&
-                employee.computerId.value() == computer.id) {
-                assigned = true;
-                break;
-            }
-        }
+    std::vector<Computer> freeComputers;
+    freeComputers.reserve(computers.size() - std::min(computers.size(), computerOwners.size()));
 
-        if (!assigned)
-            freeComputers.push_back(computer);
-    }
+    selectComputers({ { ComputerColumn::Assigned, 0, 0 } })
+        .forEach([&](size_t slot) { freeComputers.push_back(computers[slot]); });
 
     return freeComputers;
 }
 
-const std::vector<Employee>& Database::getEmployees() const {
+const RecordTable<Employee>& Database::getEmployees() const {
     return employees;
 }
 
-const std::vector<Computer>& Database::getComputers() const {
+const RecordTable<Computer>& Database::getComputers() const {
     return computers;
 }
 
 std::vector<Computer> Database::getComputersWithRamLessThan(int value) const {
 
     std::vector<Computer> result;
+    if (value == INT32_MIN)
+        return result;
 
-    for (const auto& c : computers) {
-        if (c.ramSize < value)
-            result.push_back(c);
+    for (int id : findComputerIdsInRange({ ComputerColumn::Ram, INT32_MIN, value - 1 }))
+        result.push_back(*findComputerById(id));
+
+    return result;
+}
+
+const std::vector<int32_t>& Database::column(ComputerColumn column) const {
+    switch (column) {
+    case ComputerColumn::Ram:
+        return ramColumn;
+    case ComputerColumn::Storage:
+        return storageColumn;
+    case ComputerColumn::LastMaintenanceDay:
+        return maintenanceColumn;
+    case ComputerColumn::WarrantyExpirationDay:
+        return warrantyColumn;
+    case ComputerColumn::Assigned:
+        return assignedColumn;
+    }
+    throw std::invalid_argument("Неизвестный столбец компьютеров");
+}
+
+const Database::OrderedIndex& Database::orderedIndex(ComputerColumn column) const {
+    switch (column) {
+    case ComputerColumn::Ram:
+        return ramOrder;
+    case ComputerColumn::Storage:
+        return storageOrder;
+    case ComputerColumn::LastMaintenanceDay:
+        return maintenanceOrder;
+    case ComputerColumn::WarrantyExpirationDay:
+        return warrantyOrder;
+    case ComputerColumn::Assigned:
+        break;
+    }
+    throw std::invalid_argument("Нет упорядоченного индекса по столбцу компьютеров");
+}
+
+column_scan::Selection Database::selectComputers(const std::vector<ComputerRange>& ranges,
+                                                 const std::vector<ComputerCategoryFilter>& categories) const {
+    column_scan::Selection selection(computers.size(), categories.empty());
+    if (!categories.empty()) {
+        selectComputerIds(categories).forEach([&](uint32_t id) {
+            selection.set(computerIndex.at(static_cast<int>(id)));
+        });
+    }
+
+    for (const auto& range : ranges) {
+        const std::vector<int32_t>& values = column(range.column);
+        column_scan::keepInRange(values.data(), values.size(), range.low, range.high, selection);
+    }
+    return selection;
+}
+
+// Значения внутри фильтра объединяются (OR), фильтры пересекаются (AND)
+template <typename Index, typename Records, typename Filter>
+static RoaringBitmap selectIds(const Index& indexes, const Records& records,
+                               const std::vector<Filter>& filters) {
+    RoaringBitmap result;
+    if (filters.empty()) {
+        for (const auto& record : records)
+            result.add(static_cast<uint32_t>(record.id));
+        return result;
     }
 
+    for (size_t i = 0; i < filters.size(); ++i) {
+        const auto& index = indexes[static_cast<size_t>(filters[i].category)];
+        RoaringBitmap matched;
+        for (const auto& value : filters[i].values) {
+            auto it = index.find(value);
+            if (it != index.end())
+                matched |= it->second;
+        }
+
+        if (i == 0)
+            result = std::move(matched);
+        else
+            result &= matched;
+    }
     return result;
 }
 
+RoaringBitmap Database::selectEmployeeIds(const std::vector<EmployeeCategoryFilter>& filters) const {
+    return selectIds(employeeCategories, employees, filters);
+}
+
+RoaringBitmap Database::selectComputerIds(const std::vector<ComputerCategoryFilter>& filters) const {
+    return selectIds(computerCategories, computers, filters);
+}
+
+template <typename Index>
+static std::vector<InternedString> indexedValues(const Index& index) {
+    std::vector<InternedString> values;
+    values.reserve(index.size());
+    for (const auto& entry : index)
+        values.push_back(entry.first);
+    return values;
+}
+
+std::vector<InternedString> Database::categoryValues(EmployeeCategory category) const {
+    return indexedValues(employeeCategories[static_cast<size_t>(category)]);
+}
+
+std::vector<InternedString> Database::categoryValues(ComputerCategory category) const {
+    return indexedValues(computerCategories[static_cast<size_t>(category)]);
+}
+
+std::vector<int> Database::findComputerIdsInRange(const ComputerRange& range) const {
+    std::vector<int> ids;
+    if (range.high < range.low)
+        return ids;
+
+    const OrderedIndex& index = orderedIndex(range.column);
+    auto last = index.upper_bound({ range.high, INT_MAX });
+    for (auto it = index.lower_bound({ range.low, INT_MIN }); it != last; ++it)
+        ids.push_back(it->second);
+    return ids;
+}
+
+std::vector<int> Database::findComputerIdsInRange(const ComputerRange& range,
+                                                  const column_scan::Selection& within) const {
+    std::vector<int> ids;
+    if (range.high < range.low)
+        return ids;
+
+    const OrderedIndex& index = orderedIndex(range.column);
+    auto last = index.upper_bound({ range.high, INT_MAX });
+    for (auto it = index.lower_bound({ range.low, INT_MIN }); it != last; ++it) {
+        size_t slot = computerIndex.at(it->second);
+        if (slot < within.size() && within.test(slot))
+            ids.push_back(it->second);
+    }
+    return ids;
+}
+
 std::vector<Employee> Database::findEmployeesByLastName(const std::string& name) const {
 
     std::vector<Employee> result;
 
-    for (const auto& e : employees) {
-        if (e.lastName.find(name) != std::string::npos)
-            result.push_back(e);
+    // Просмотр идет по плоской таблице, к записям - только для совпавших
+    for (size_t slot = 0; slot < employeeText.size(); ++slot) {
+        if (employeeText.field(slot, 0).find(name) != std::string_view::npos)
+            result.push_back(employees[slot]);
     }
 
     return result;
@@ -233,96 +787,317 @@ std::vector<Computer> Database::findComputersByInventory(const std::string& inve
 
     std::vector<Computer> result;
 
-    for (const auto& c : computers) {
-        if (c.inventoryNumber.find(inventory) != std::string::npos)
-            result.push_back(c);
+    for (size_t slot = 0; slot < computerText.size(); ++slot) {
+        if (computerText.field(slot, 0).find(inventory) != std::string_view::npos)
+            result.push_back(computers[slot]);
     }
 
     return result;
 }
 
-void Database::validate() const {
+// Пары сортируются в векторе и вставляются в set по порядку: вставка
+// с подсказкой в конец идет за O(1) вместо поиска места для каждой пары
+void Database::buildOrderedIndex(const std::vector<int32_t>& column, OrderedIndex& index) const {
+    std::vector<std::pair<int32_t, int>> keys;
+    keys.reserve(column.size());
+    for (size_t slot = 0; slot < column.size(); ++slot)
+        keys.emplace_back(column[slot], computers[slot].id);
+    std::sort(keys.begin(), keys.end());
+
+    index.clear();
+    for (const auto& key : keys)
+        index.emplace_hint(index.end(), key);
+}
 
-    std::vector<std::string> errors;
+// Таблицы строятся заново с точным размером арены, без сжатий по ходу
+void Database::rebuildScanTables() {
+    size_t employeeBytes = 0;
+    for (const auto& e : employees)
+        employeeBytes += e.lastName.size();
+    employeeText.clear();
+    employeeText.reserve(employees.size(), employeeBytes);
+    for (const auto& e : employees)
+        employeeText.append(e.id, { e.lastName });
+
+    size_t computerBytes = 0;
+    for (const auto& c : computers)
+        computerBytes += c.inventoryNumber.size();
+    computerText.clear();
+    computerText.reserve(computers.size(), computerBytes);
+    for (const auto& c : computers)
+        computerText.append(c.id, { c.inventoryNumber });
+
+    ramColumn.clear();
+    storageColumn.clear();
+    maintenanceColumn.clear();
+    warrantyColumn.clear();
+    assignedColumn.clear();
+    ramColumn.reserve(computers.size());
+    storageColumn.reserve(computers.size());
+    maintenanceColumn.reserve(computers.size());
+    warrantyColumn.reserve(computers.size());
+    assignedColumn.reserve(computers.size());
+    for (const auto& c : computers) {
+        ramColumn.push_back(c.ramSize);
+        storageColumn.push_back(c.storageSize);
+        maintenanceColumn.push_back(c.lastMaintenanceDay);
+        warrantyColumn.push_back(c.warrantyExpirationDay);
+        assignedColumn.push_back(isComputerAssigned(c.id) ? 1 : 0);
+    }
+
+    buildOrderedIndex(ramColumn, ramOrder);
+    buildOrderedIndex(storageColumn, storageOrder);
+    buildOrderedIndex(maintenanceColumn, maintenanceOrder);
+    buildOrderedIndex(warrantyColumn, warrantyOrder);
+
+    for (auto& index : employeeCategories)
+        index.clear();
+    for (auto& index : computerCategories)
+        index.clear();
+    for (const auto& e : employees)
+        indexCategories(e);
+    for (const auto& c : computers)
+        indexCategories(c);
+}
 
-    std::unordered_set<int> employeeIds;
-    std::unordered_set<int> computerIds;
-    std::unordered_set<int> assignedComputers;
+void Database::compactStorage() {
+    employeeText.compact();
+    computerText.compact();
+}
 
-    for (const auto& e : employees) {
-        if (e.id <= 0)
-            errors.push_back("Некорректный ID сотрудника: " + std::to_string(e.id));
+static void throwValidationErrors(const std::vector<std::string>& errors) {
+    std::ostringstream message;
+    message << "Ошибка валидации базы данных:\n";
+    for (const auto& err : errors)
+        message << "- " << err << "\n";
+    throw std::runtime_error(message.str());
+}
 
-        if (!employeeIds.insert(e.id).second)
-            errors.push_back("Дублируется ID сотрудника: " + std::to_string(e.id));
+// Дата проверяется по уже разобранному номеру дня; подпись поля
+// собирается только для ошибочной даты, а не для каждой записи
+static void checkDateField(date_utils::DayNumber day,
+                           const std::string& value,
+                           const char* field,
+                           const char* owner,
+                           int id,
+                           date_utils::DayNumber today,
+                           bool allowFuture,
+                           std::vector<std::string>& errors) {
+    date_utils::DateStatus status = date_utils::checkDay(day, today, allowFuture);
+    if (status == date_utils::DateStatus::Ok)
+        return;
+
+    errors.push_back(date_utils::describeDateError(
+        status, std::string(field) + " (" + owner + " " + std::to_string(id) + ")", value));
+}
+
+void Database::checkEmployee(const Employee& e,
+                             date_utils::DayNumber today,
+                             std::vector<std::string>& errors) const {
+    if (e.id <= 0)
+        errors.push_back("Некорректный ID сотрудника: " + std::to_string(e.id));
 
-        date_utils::validateDateField(e.employmentDate,
-                                      "employmentDate (ID сотрудника " + std::to_string(e.id) + ")",
-                                      errors,
-                                      false);
+    checkDateField(e.employmentDay, e.employmentDate, "employmentDate", "ID сотрудника", e.id,
+                   today, false, errors);
+}
+
+void Database::checkComputer(const Computer& c,
+                             date_utils::DayNumber today,
+                             std::vector<std::string>& errors) const {
+    if (c.id <= 0)
+        errors.push_back("Некорректный ID компьютера: " + std::to_string(c.id));
+
+    // Индексы хранят первую запись с данным номером, все последующие - дубликаты
+    auto inv = inventoryIndex.find(c.inventoryNumber);
+    if (inv == inventoryIndex.end() || inv->second != c.id)
+        errors.push_back("Дублируется инвентарный номер: " + c.inventoryNumber);
+
+    auto serial = serialIndex.find(c.serialNumber);
+    if (serial == serialIndex.end() || serial->second != c.id)
+        errors.push_back("Дублируется серийный номер: " + c.serialNumber);
+
+    if (c.inventoryNumber.empty())
+        errors.push_back("Инвентарный номер не может быть пустым (ID компьютера " + std::to_string(c.id) + ")");
+
+    if (c.serialNumber.empty())
+        errors.push_back("Серийный номер не может быть пустым (ID компьютера " + std::to_string(c.id) + ")");
+
+    if (c.ramSize <= 0)
+        errors.push_back("ramSize должен быть больше 0 (ID компьютера " + std::to_string(c.id) + ")");
+
+    if (c.storageSize <= 0)
+        errors.push_back("storageSize должен быть больше 0 (ID компьютера " + std::to_string(c.id) + ")");
+
+    checkDateField(c.commissioningDay, c.commissioningDate, "commissioningDate", "ID компьютера", c.id,
+                   today, false, errors);
+    checkDateField(c.lastMaintenanceDay, c.lastMaintenanceDate, "lastMaintenanceDate", "ID компьютера", c.id,
+                   today, false, errors);
+    checkDateField(c.warrantyExpirationDay, c.warrantyExpirationDate, "warrantyExpirationDate", "ID компьютера", c.id,
+                   today, true, errors);
+}
+
+void Database::checkAssignment(const Employee& e, std::vector<std::string>& errors) const {
+    if (!e.computerId.has_value())
+        return;
+
+    int compId = e.computerId.value();
+    auto owner = computerOwners.find(compId);
+    if (computerIndex.find(compId) == computerIndex.end()) {
+        errors.push_back("Назначен несуществующий компьютер (ID компьютера " +
+                         std::to_string(compId) +
+                         ", ID сотрудника " + std::to_string(e.id) + ")");
+    } else if (owner == computerOwners.end() || owner->second != e.id) {
+        errors.push_back("Компьютер назначен нескольким сотрудникам (ID компьютера " +
+                         std::to_string(compId) + ")");
     }
+}
 
-    std::unordered_set<std::string> inventoryNumbers;
-    std::unordered_set<std::string> serialNumbers;
+// Таблицы меньше этого размера проверяются одним заданием, без деления на части
+static const size_t kParallelValidationThreshold = 16 * 1024;
+
+// Повторные ID ищутся по долям: задача p отвечает за ID с id % parts == p
+// и проходит записи по порядку, поэтому дубликатом, как и при
+// последовательном проходе, считается каждая следующая запись с тем же ID
+template <typename Table>
+static std::vector<char> findDuplicateIds(const Table& records, ThreadPool& pool) {
+    std::vector<char> duplicate(records.size(), 0);
+
+    auto scan = [&records, &duplicate](size_t part, size_t parts) {
+        std::unordered_set<int> seen;
+        seen.reserve(records.size() / parts + 1);
+        for (size_t i = 0; i < records.size(); ++i) {
+            int id = records[i].id;
+            if (static_cast<unsigned>(id) % parts == part && !seen.insert(id).second)
+                duplicate[i] = 1;
+        }
+    };
 
-    for (const auto& c : computers) {
-        if (c.id <= 0)
-            errors.push_back("Некорректный ID компьютера: " + std::to_string(c.id));
+    if (records.size() < kParallelValidationThreshold) {
+        scan(0, 1);
+        return duplicate;
+    }
+
+    size_t parts = pool.size();
+    std::vector<std::future<void>> tasks;
+    tasks.reserve(parts);
+    for (size_t part = 0; part < parts; ++part)
+        tasks.push_back(pool.submit([&scan, part, parts]() { scan(part, parts); }));
+    waitAll(tasks);
+    return duplicate;
+}
 
-        if (!computerIds.insert(c.id).second)
-            errors.push_back("Дублируется ID компьютера: " + std::to_string(c.id));
+// Проверяет записи [0, count) диапазонами в пуле; ошибки диапазона
+// собираются отдельно, а затем склеиваются в порядке записей
+template <typename Check>
+static void submitChecks(ThreadPool& pool,
+                         size_t count,
+                         Check check,
+                         std::vector<std::future<std::vector<std::string>>>& parts) {
+    size_t rangeCount = count < kParallelValidationThreshold ? 1 : pool.size() * 4;
+    size_t rangeSize = (count + rangeCount - 1) / rangeCount;
+
+    for (size_t begin = 0; begin < count; begin += rangeSize) {
+        size_t end = std::min(count, begin + rangeSize);
+        parts.push_back(pool.submit([check, begin, end]() {
+            std::vector<std::string> errors;
+            for (size_t i = begin; i < end; ++i)
+                check(i, errors);
+            return errors;
+        }));
+    }
+}
+
+void Database::validate() const {
+    ThreadPool& pool = ThreadPool::shared();
+    date_utils::DayNumber today = date_utils::today();
+
+    const RecordTable<Employee>& employeeRecords = employees;
+    const RecordTable<Computer>& computerRecords = computers;
+
+    std::vector<char> duplicateEmployees = findDuplicateIds(employeeRecords, pool);
+    std::vector<char> duplicateComputers = findDuplicateIds(computerRecords, pool);
+
+    std::vector<std::future<std::vector<std::string>>> parts;
+
+    submitChecks(pool, employeeRecords.size(),
+                 [this, &employeeRecords, &duplicateEmployees, today](size_t i, std::vector<std::string>& errors) {
+                     const Employee& e = employeeRecords[i];
+                     if (duplicateEmployees[i])
+                         errors.push_back("Дублируется ID сотрудника: " + std::to_string(e.id));
+                     checkEmployee(e, today, errors);
+                 },
+                 parts);
+
+    submitChecks(pool, computerRecords.size(),
+                 [this, &computerRecords, &duplicateComputers, today](size_t i, std::vector<std::string>& errors) {
+                     const Computer& c = computerRecords[i];
+                     if (duplicateComputers[i])
+                         errors.push_back("Дублируется ID компьютера: " + std::to_string(c.id));
+                     checkComputer(c, today, errors);
+                 },
+                 parts);
+
+    submitChecks(pool, employeeRecords.size(),
+                 [this, &employeeRecords](size_t i, std::vector<std::string>& errors) {
+                     checkAssignment(employeeRecords[i], errors);
+                 },
+                 parts);
 
-        if (!inventoryNumbers.insert(c.inventoryNumber).second)
-            errors.push_back("Дублируется инвентарный номер: " + c.inventoryNumber);
+    std::vector<std::string> errors;
+    for (auto& part : waitAll(parts))
+        errors.insert(errors.end(),
+                      std::make_move_iterator(part.begin()),
+                      std::make_move_iterator(part.end()));
 
-        if (!serialNumbers.insert(c.serialNumber).second)
-            errors.push_back("Дублируется серийный номер: " + c.serialNumber);
+    if (!errors.empty())
+        throwValidationErrors(errors);
 
-        if (c.inventoryNumber.empty())
-            errors.push_back("Инвентарный номер не может быть пустым (ID компьютера " + std::to_string(c.id) + ")");
+    uncheckedEmployeeIds.clear();
+    uncheckedComputerIds.clear();
+    uncheckedAll = false;
+}
 
-        if (c.serialNumber.empty())
-            errors.push_back("Серийный номер не может быть пустым (ID компьютера " + std::to_string(c.id) + ")");
+void Database::validateChanges() const {
+    if (uncheckedAll) {
+        validate();
+        return;
+    }
 
-        if (c.ramSize <= 0)
-            errors.push_back("ramSize должен быть больше 0 (ID компьютера " + std::to_string(c.id) + ")");
+    std::vector<std::string> errors;
+    date_utils::DayNumber today = date_utils::today();
 
-        if (c.storageSize <= 0)
-            errors.push_back("storageSize должен быть больше 0 (ID компьютера " + std::to_string(c.id) + ")");
+    // Порядок ошибок не зависит от порядка в хеш-множествах
+    std::vector<int> employeeIds(uncheckedEmployeeIds.begin(), uncheckedEmployeeIds.end());
+    std::sort(employeeIds.begin(), employeeIds.end());
+    std::vector<int> computerIds(uncheckedComputerIds.begin(), uncheckedComputerIds.end());
+    std::sort(computerIds.begin(), computerIds.end());
 
-        date_utils::validateDateField(c.commissioningDate,
-                                      "commissioningDate (ID компьютера " + std::to_string(c.id) + ")",
-                                      errors,
-                                      false);
-        date_utils::validateDateField(c.lastMaintenanceDate,
-                                      "lastMaintenanceDate (ID компьютера " + std::to_string(c.id) + ")",
-                                      errors,
-                                      false);
-        date_utils::validateDateField(c.warrantyExpirationDate,
-                                      "warrantyExpirationDate (ID компьютера " + std::to_string(c.id) + ")",
-                                      errors,
-                                      true);
+    for (int id : employeeIds) {
+        if (const Employee* e = findEmployeeById(id))
+            checkEmployee(*e, today, errors);
     }
 
-    for (const auto& e : employees) {
-        if (e.computerId.has_value()) {
-            int compId = e.computerId.value();
-            if (computerIds.find(compId) == computerIds.end()) {
+    for (int id : computerIds) {
+        if (const Computer* c = findComputerById(id)) {
+            checkComputer(*c, today, errors);
+        } else {
+            // Удаленный компьютер не должен оставаться за сотрудником
+            auto owner = computerOwners.find(id);
+            if (owner != computerOwners.end())
                 errors.push_back("Назначен несуществующий компьютер (ID компьютера " +
-                                 std::to_string(compId) +
-                                 ", ID сотрудника " + std::to_string(e.id) + ")");
-            } else if (!assignedComputers.insert(compId).second) {
-                errors.push_back("Компьютер назначен нескольким сотрудникам (ID компьютера " +
-                                 std::to_string(compId) + ")");
-            }
+                                 std::to_string(id) +
+                                 ", ID сотрудника " + std::to_string(owner->second) + ")");
         }
     }
 
-    if (!errors.empty()) {
-        std::ostringstream message;
-        message << "Ошибка валидации базы данных:\n";
-        for (const auto& err : errors)
-            message << "- " << err << "\n";
-        throw std::runtime_error(message.str());
+    for (int id : employeeIds) {
+        if (const Employee* e = findEmployeeById(id))
+            checkAssignment(*e, errors);
     }
+
+    if (!errors.empty())
+        throwValidationErrors(errors);
+
+    uncheckedEmployeeIds.clear();
+    uncheckedComputerIds.clear();
 }
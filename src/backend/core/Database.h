@@ -1,50 +1,245 @@
 #pragma once
 #include <vector>
+#include <array>
 #include <optional>
+#include <set>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "ChangeSet.h"
+#include "FlatTable.h"
+#include "RecordTable.h"
+#include "../utils/ColumnScan.h"
+#include "../utils/RoaringBitmap.h"
 #include "../models/Employee.h"
 #include "../models/Computer.h"
 
+// Неизменяемый снимок записей базы. Блоки таблиц разделяются с базой,
+// поэтому снимок копирует только указатели на блоки и может читаться
+// из другого потока, пока база продолжает изменяться.
+struct DatabaseSnapshot {
+    RecordTable<Employee> employees;
+    RecordTable<Computer> computers;
+};
+
+// Числовые поля компьютера, по которым возможен отбор диапазоном
+enum class ComputerColumn {
+    Ram,
+    Storage,
+    LastMaintenanceDay,
+    WarrantyExpirationDay,
+    Assigned            // 1 - компьютер закреплен за сотрудником, 0 - свободен
+};
+
+// Условие low <= значение <= high по одному столбцу
+struct ComputerRange {
+    ComputerColumn column;
+    int32_t low;
+    int32_t high;
+};
+
+// Поля с малым числом различных значений, по которым ведутся индексы
+// равенства (битовые карты ID записей на каждое значение)
+enum class EmployeeCategory {
+    Institute,
+    Department,
+    Status
+};
+
+enum class ComputerCategory {
+    Manufacturer,
+    StorageType,
+    RoomNumber,
+    Condition
+};
+
+// Условие "значение поля - одно из values"
+struct EmployeeCategoryFilter {
+    EmployeeCategory category;
+    std::vector<InternedString> values;
+};
+
+struct ComputerCategoryFilter {
+    ComputerCategory category;
+    std::vector<InternedString> values;
+};
+
 class Database {
 private:
-    std::vector<Employee> employees;
-    std::vector<Computer> computers;
+    // Блоки таблиц общие со снимками: пока снимок жив, изменение записи
+    // копирует только ее блок (RecordTable::kChunkSize записей). Позиция
+    // записи (slot) сквозная по всей таблице, как у вектора
+    RecordTable<Employee> employees;
+    RecordTable<Computer> computers;
+
+    // Поля поиска по подстроке (фамилия, инвентарный номер) в плоском виде,
+    // в том же порядке, что и записи в employees/computers
+    FlatTable<1> employeeText;
+    FlatTable<1> computerText;
+
+    // Числовые поля компьютеров отдельными массивами в порядке computers:
+    // отбор по диапазонам (selectComputers) читает только нужные столбцы
+    std::vector<int32_t> ramColumn;
+    std::vector<int32_t> storageColumn;
+    std::vector<int32_t> maintenanceColumn;
+    std::vector<int32_t> warrantyColumn;
+    std::vector<int32_t> assignedColumn;
+
+    // Упорядоченные индексы (значение, ID) по тем же столбцам, кроме
+    // Assigned: запрос диапазона сразу дает ID в порядке значения
+    using OrderedIndex = std::set<std::pair<int32_t, int>>;
+    OrderedIndex ramOrder;
+    OrderedIndex storageOrder;
+    OrderedIndex maintenanceOrder;
+    OrderedIndex warrantyOrder;
+
+    // Значение поля -> ID записей с этим значением, по карте на поле
+    // (порядок как в EmployeeCategory/ComputerCategory)
+    using CategoryIndex = std::unordered_map<InternedString, RoaringBitmap>;
+    std::array<CategoryIndex, 3> employeeCategories;
+    std::array<CategoryIndex, 4> computerCategories;
+
+    // id -> позиция записи в employees/computers
+    std::unordered_map<int, size_t> employeeIndex;
+    std::unordered_map<int, size_t> computerIndex;
+
+    // инвентарный/серийный номер -> id компьютера
+    std::unordered_map<std::string, int> inventoryIndex;
+    std::unordered_map<std::string, int> serialIndex;
+
+    // id компьютера -> id сотрудника, за которым он закреплен
+    std::unordered_map<int, int> computerOwners;
 
     int nextEmployeeId = 1;
     int nextComputerId = 1;
 
+    // ID записей, добавленных, измененных или удаленных после clearChanges()
+    std::unordered_set<int> changedEmployeeIds;
+    std::unordered_set<int> changedComputerIds;
+
+    // Записи, не проверенные после последней успешной валидации;
+    // uncheckedAll - проверить нужно все записи (после bulkLoad)
+    mutable std::unordered_set<int> uncheckedEmployeeIds;
+    mutable std::unordered_set<int> uncheckedComputerIds;
+    mutable bool uncheckedAll = false;
+
+    void reindexEmployeesFrom(size_t slot);
+    void reindexComputersFrom(size_t slot);
+    void indexComputerKeys(const Computer& computer);
+    void unindexComputerKeys(const Computer& computer);
+    void claimComputer(const Employee& employee);
+    void releaseComputer(const Employee& employee);
+    void touchEmployee(int id);
+    void touchComputer(int id);
+    void rebuildScanTables();
+    void buildOrderedIndex(const std::vector<int32_t>& column, OrderedIndex& index) const;
+    void appendComputerColumns(const Computer& computer);
+    void assignComputerColumns(size_t slot, const Computer& computer);
+    void eraseComputerColumns(size_t slot, int id);
+    void markAssigned(int computerId, bool assigned);
+    const std::vector<int32_t>& column(ComputerColumn column) const;
+    const OrderedIndex& orderedIndex(ComputerColumn column) const;
+    void indexCategories(const Employee& employee);
+    void indexCategories(const Computer& computer);
+    void unindexCategories(const Employee& employee);
+    void unindexCategories(const Computer& computer);
+
+    // Проверки отдельной записи, общие для полной и инкрементальной валидации
+    void checkEmployee(const Employee& e,
+                       date_utils::DayNumber today,
+                       std::vector<std::string>& errors) const;
+    void checkComputer(const Computer& c,
+                       date_utils::DayNumber today,
+                       std::vector<std::string>& errors) const;
+    void checkAssignment(const Employee& e, std::vector<std::string>& errors) const;
+
 public:
+    // Как и assignComputer, не принимает компьютер, уже закрепленный за
+    // другим сотрудником: возвращает 0 вместо ID
     int addEmployee(Employee employee);
     int addComputer(Computer computer);
 
     int addEmployeeWithId(const Employee& employee);
     int addComputerWithId(const Computer& computer);
 
+    // Заменяет содержимое базы загруженными записями: записи переносятся без
+    // поштучных проверок, индексы и проверка ID выполняются одним проходом.
+    void bulkLoad(std::vector<Employee> loadedEmployees,
+                  std::vector<Computer> loadedComputers);
+
+    // Применяет изменения из журнала поверх текущих записей по порядку:
+    // существующие записи заменяются на месте, новые добавляются в конец.
+    // Индексы перестраиваются один раз, как в bulkLoad.
+    void applyChanges(const std::vector<ChangeSet>& changeSets);
+
+    // Изменения с последнего сохранения (для журнала)
+    bool hasChanges() const;
+    ChangeSet collectChanges() const;
+    void clearChanges();
+
+    DatabaseSnapshot snapshot() const;
+
     void removeEmployee(int id);
     void removeComputer(int id);
 
+    // false - сотрудника нет или его компьютер закреплен за другим
     bool updateEmployee(const Employee& employee);
     bool updateComputer(const Computer& computer);
 
     Employee* findEmployeeById(int id);
     Computer* findComputerById(int id);
+    const Employee* findEmployeeById(int id) const;
+    const Computer* findComputerById(int id) const;
 
     bool isInventoryNumberUnique(const std::string& inventoryNumber) const;
     bool isSerialNumberUnique(const std::string& serialNumber) const;
+    const Computer* findComputerByInventoryNumber(const std::string& inventoryNumber) const;
+    const Computer* findComputerBySerialNumber(const std::string& serialNumber) const;
 
     bool assignComputer(int employeeId, int computerId);
     bool unassignComputer(int employeeId);
     bool unassignComputerByComputerId(int computerId);
 
+    const Employee* ownerOf(int computerId) const;
+    bool isComputerAssigned(int computerId) const;
     std::vector<Computer> getFreeComputers() const;
 
-    const std::vector<Employee>& getEmployees() const;
-    const std::vector<Computer>& getComputers() const;
+    // Ссылки действительны до следующего изменения базы
+    const RecordTable<Employee>& getEmployees() const;
+    const RecordTable<Computer>& getComputers() const;
 
     std::vector<Computer> getComputersWithRamLessThan(int value) const;
 
+    // Позиции в getComputers() компьютеров, подходящих под все условия
+    // по категориям и диапазонам
+    column_scan::Selection selectComputers(const std::vector<ComputerRange>& ranges,
+                                           const std::vector<ComputerCategoryFilter>& categories = {}) const;
+
+    // ID записей, подходящих под все фильтры по категориям; без фильтров - все ID
+    RoaringBitmap selectEmployeeIds(const std::vector<EmployeeCategoryFilter>& filters) const;
+    RoaringBitmap selectComputerIds(const std::vector<ComputerCategoryFilter>& filters) const;
+
+    // Различные значения поля, встречающиеся в базе
+    std::vector<InternedString> categoryValues(EmployeeCategory category) const;
+    std::vector<InternedString> categoryValues(ComputerCategory category) const;
+
+    // ID компьютеров со значением столбца в диапазоне, по возрастанию
+    // значения, при равных - по ID; столбец Assigned не индексируется
+    std::vector<int> findComputerIdsInRange(const ComputerRange& range) const;
+    // То же только среди позиций, отобранных selectComputers
+    std::vector<int> findComputerIdsInRange(const ComputerRange& range,
+                                            const column_scan::Selection& within) const;
+
     std::vector<Employee> findEmployeesByLastName(const std::string& name) const;
     std::vector<Computer> findComputersByInventory(const std::string& inventory) const;
 
+    // Освобождает в плоских таблицах поиска место замененных строк
+    void compactStorage();
+
+    // Полная проверка всех записей
     void validate() const;
+    // Проверка только записей, измененных после последней успешной проверки,
+    // и связанных с ними ограничений (уникальность номеров, один владелец
+    // компьютера); после bulkLoad выполняется полная проверка
+    void validateChanges() const;
 };
@@ -0,0 +1,20 @@
+#include "FlatTable.h"
+
+#include <limits>
+#include <stdexcept>
+
+StringArena::Ref StringArena::append(std::string_view value) {
+    if (bytes.size() + value.size() > std::numeric_limits<uint32_t>::max())
+        throw std::length_error("Превышен размер области строк таблицы");
+
+    Ref ref;
+    ref.offset = static_cast<uint32_t>(bytes.size());
+    ref.length = static_cast<uint32_t>(value.size());
+    bytes.insert(bytes.end(), value.begin(), value.end());
+    return ref;
+}
+
+void StringArena::clear() {
+    bytes.clear();
+    garbage = 0;
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Общая непрерывная память для строк: строка дописывается в конец и
+// адресуется парой (смещение, длина). Место замененных строк не
+// переиспользуется, а собирается при сжатии таблицы (FlatTable::compact).
+class StringArena {
+public:
+    struct Ref {
+        uint32_t offset = 0;
+        uint32_t length = 0;
+    };
+
+    Ref append(std::string_view value);
+
+    std::string_view view(Ref ref) const {
+        return std::string_view(bytes.data() + ref.offset, ref.length);
+    }
+
+    void release(Ref ref) { garbage += ref.length; }
+
+    size_t size() const { return bytes.size(); }
+    size_t garbageSize() const { return garbage; }
+    size_t capacity() const { return bytes.capacity(); }
+
+    void reserve(size_t size) { bytes.reserve(size); }
+    void clear();
+
+private:
+    std::vector<char> bytes;
+    size_t garbage = 0;
+};
+
+// Таблица для последовательного просмотра строковых полей: записи
+// фиксированного размера (ID и ссылки на Fields строк) лежат подряд,
+// а строки всех записей - в одной арене, без отдельных выделений памяти
+// на каждое поле. Порядок строк совпадает с порядком записей в Database.
+template <size_t Fields>
+class FlatTable {
+public:
+    using Values = std::array<std::string_view, Fields>;
+
+    size_t size() const { return rows.size(); }
+    int id(size_t slot) const { return rows[slot].id; }
+
+    std::string_view field(size_t slot, size_t index) const {
+        return arena.view(rows[slot].fields[index]);
+    }
+
+    void reserve(size_t rowCount, size_t byteCount) {
+        rows.reserve(rowCount);
+        arena.reserve(byteCount);
+    }
+
+    void append(int id, const Values& values) {
+        Row row;
+        row.id = id;
+        for (size_t i = 0; i < Fields; ++i)
+            row.fields[i] = arena.append(values[i]);
+        rows.push_back(row);
+    }
+
+    void assign(size_t slot, int id, const Values& values) {
+        Row& row = rows[slot];
+        row.id = id;
+        for (size_t i = 0; i < Fields; ++i) {
+            if (arena.view(row.fields[i]) == values[i])
+                continue;
+            arena.release(row.fields[i]);
+            row.fields[i] = arena.append(values[i]);
+        }
+        compactIfSparse();
+    }
+
+    void erase(size_t slot) {
+        for (size_t i = 0; i < Fields; ++i)
+            arena.release(rows[slot].fields[i]);
+        rows.erase(rows.begin() + slot);
+        compactIfSparse();
+    }
+
+    void clear() {
+        rows.clear();
+        arena.clear();
+    }
+
+    // Переписывает строки подряд в порядке записей, отбрасывая замененные
+    void compact() {
+        StringArena packed;
+        packed.reserve(arena.size() - arena.garbageSize());
+        for (Row& row : rows) {
+            for (size_t i = 0; i < Fields; ++i)
+                row.fields[i] = packed.append(arena.view(row.fields[i]));
+        }
+        arena = std::move(packed);
+    }
+
+    size_t memoryUsage() const {
+        return rows.capacity() * sizeof(Row) + arena.capacity();
+    }
+
+private:
+    struct Row {
+        int id;
+        StringArena::Ref fields[Fields];
+    };
+
+    std::vector<Row> rows;
+    StringArena arena;
+
+    // Арена сжимается, когда больше половины ее занимают замененные строки
+    void compactIfSparse() {
+        if (arena.garbageSize() > arena.size() / 2)
+            compact();
+    }
+};
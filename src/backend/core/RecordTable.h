@@ -0,0 +1,195 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+// Таблица записей из блоков до kChunkSize записей, которые разделяются
+// со снимками. Снимок (копия таблицы) копирует только указатели на блоки;
+// изменение записи в разделенном блоке сначала копирует этот блок, так что
+// правка, пока снимок жив, стоит одного блока, а не всей таблицы.
+//
+// Какие блоки принадлежат таблице, хранится в ней самой (owned) и
+// сбрасывается при копировании в потоке владельца таблицы. Счетчик ссылок
+// shared_ptr для этого не читается: снимок, отданный другому потоку,
+// только читает свои блоки и никогда их не меняет.
+template <typename Record>
+class RecordTable {
+public:
+    static const size_t kChunkSize = 1024;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Record;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Record*;
+        using reference = const Record&;
+
+        const_iterator() = default;
+
+        reference operator*() const { return (*table->chunks[chunk])[offset]; }
+        pointer operator->() const { return &**this; }
+
+        const_iterator& operator++() {
+            if (++offset == table->chunks[chunk]->size()) {
+                ++chunk;
+                offset = 0;
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const const_iterator& other) const {
+            return chunk == other.chunk && offset == other.offset;
+        }
+        bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+    private:
+        friend class RecordTable;
+
+        const_iterator(const RecordTable* table, size_t chunk)
+            : table(table), chunk(chunk) {}
+
+        const RecordTable* table = nullptr;
+        size_t chunk = 0;
+        size_t offset = 0;
+    };
+
+    RecordTable() = default;
+
+    // Записи раскладываются по полным блокам
+    explicit RecordTable(std::vector<Record> records) {
+        if (records.size() <= kChunkSize) {
+            if (!records.empty())
+                appendChunk(std::make_shared<Chunk>(std::move(records)));
+            return;
+        }
+
+        for (size_t begin = 0; begin < records.size(); begin += kChunkSize) {
+            size_t end = std::min(records.size(), begin + kChunkSize);
+            auto chunk = std::make_shared<Chunk>();
+            chunk->reserve(kChunkSize);
+            chunk->insert(chunk->end(),
+                          std::make_move_iterator(records.begin() + begin),
+                          std::make_move_iterator(records.begin() + end));
+            appendChunk(std::move(chunk));
+        }
+    }
+
+    // Копия разделяет блоки с исходной таблицей, и обе перестают ими владеть.
+    // У таблицы, которая уже ничем не владеет (снимок), флаги только читаются,
+    // поэтому снимок можно копировать из любого потока
+    RecordTable(const RecordTable& other)
+        : chunks(other.chunks),
+          starts(other.starts),
+          owned(other.owned.size(), 0),
+          count(other.count)
+    {
+        other.release();
+    }
+
+    RecordTable& operator=(const RecordTable& other) {
+        if (this != &other)
+            *this = RecordTable(other);
+        return *this;
+    }
+
+    RecordTable(RecordTable&&) = default;
+    RecordTable& operator=(RecordTable&&) = default;
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, chunks.size()); }
+
+    const Record& operator[](size_t slot) const {
+        size_t chunk = chunkOf(slot);
+        return (*chunks[chunk])[slot - starts[chunk]];
+    }
+
+    const Record& back() const { return chunks.back()->back(); }
+
+    // Изменяемый доступ к записи; разделенный блок перед этим копируется.
+    // Ссылка действительна до следующего изменения таблицы
+    Record& writable(size_t slot) {
+        size_t chunk = chunkOf(slot);
+        return writableChunk(chunk)[slot - starts[chunk]];
+    }
+
+    void push_back(const Record& record) {
+        if (chunks.empty() || chunks.back()->size() == kChunkSize) {
+            auto chunk = std::make_shared<Chunk>();
+            chunk->reserve(kChunkSize);
+            appendChunk(std::move(chunk));
+        }
+        writableChunk(chunks.size() - 1).push_back(record);
+        ++count;
+    }
+
+    // Удаление сдвигает записи только внутри своего блока; опустевший блок
+    // удаляется, у последующих уменьшается номер первой записи
+    void erase(size_t slot) {
+        size_t chunk = chunkOf(slot);
+        Chunk& records = writableChunk(chunk);
+        records.erase(records.begin() + (slot - starts[chunk]));
+        --count;
+
+        size_t next = chunk + 1;
+        if (records.empty()) {
+            chunks.erase(chunks.begin() + chunk);
+            starts.erase(starts.begin() + chunk);
+            owned.erase(owned.begin() + chunk);
+            next = chunk;
+        }
+        for (size_t i = next; i < starts.size(); ++i)
+            --starts[i];
+    }
+
+private:
+    using Chunk = std::vector<Record>;
+
+    std::vector<std::shared_ptr<Chunk>> chunks;
+    std::vector<size_t> starts;         // позиция первой записи каждого блока
+    mutable std::vector<char> owned;    // 1 - блок не виден ни одному снимку
+    size_t count = 0;
+
+    void appendChunk(std::shared_ptr<Chunk> chunk) {
+        starts.push_back(count);
+        count += chunk->size();
+        chunks.push_back(std::move(chunk));
+        owned.push_back(1);
+    }
+
+    void release() const {
+        for (char& flag : owned)
+            if (flag)
+                flag = 0;
+    }
+
+    Chunk& writableChunk(size_t chunk) {
+        if (!owned[chunk]) {
+            auto copy = std::make_shared<Chunk>();
+            copy->reserve(kChunkSize);
+            copy->insert(copy->end(), chunks[chunk]->begin(), chunks[chunk]->end());
+            chunks[chunk] = std::move(copy);
+            owned[chunk] = 1;
+        }
+        return *chunks[chunk];
+    }
+
+    // Блоки не длиннее kChunkSize, поэтому запись slot лежит не раньше
+    // блока slot / kChunkSize; без удалений это и есть ее блок
+    size_t chunkOf(size_t slot) const {
+        size_t first = std::min(slot / kChunkSize, starts.size() - 1);
+        return static_cast<size_t>(std::upper_bound(starts.begin() + first, starts.end(), slot) -
+                                   starts.begin()) - 1;
+    }
+};
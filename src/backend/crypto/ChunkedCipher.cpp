@@ -0,0 +1,479 @@
+#include "ChunkedCipher.h"
+#include "CipherContextPool.h"
+#include "../utils/ThreadPool.h"
+
+#include <openssl/crypto.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+
+namespace chunked_cipher {
+
+bool hasHeader(const unsigned char* data, size_t size) {
+    return size >= kBaseHeaderSize && std::memcmp(data, kMagic, sizeof(kMagic)) == 0;
+}
+
+}
+
+using namespace chunked_cipher;
+
+static void putUInt32(unsigned char* target, uint32_t value) {
+    std::memcpy(target, &value, sizeof(value));
+}
+
+static uint32_t getUInt32(const unsigned char* source) {
+    uint32_t value;
+    std::memcpy(&value, source, sizeof(value));
+    return value;
+}
+
+static void makeNonce(const std::vector<unsigned char>& header,
+                      uint32_t chunkIndex,
+                      unsigned char* nonce) {
+    std::memcpy(nonce, header.data() + kBaseHeaderSize - kNoncePrefixSize, kNoncePrefixSize);
+    nonce[8] = static_cast<unsigned char>(chunkIndex >> 24);
+    nonce[9] = static_cast<unsigned char>(chunkIndex >> 16);
+    nonce[10] = static_cast<unsigned char>(chunkIndex >> 8);
+    nonce[11] = static_cast<unsigned char>(chunkIndex);
+}
+
+// Контрольное значение ключа: HMAC-SHA256 полей заголовка перед ним на подключе
+// HMAC(key, "PCAE key check"), чтобы сам ключ шифрования в HMAC не участвовал
+static void computeKeyCheck(const std::vector<unsigned char>& key,
+                            const unsigned char* header,
+                            size_t headerSize,
+                            unsigned char* keyCheck) {
+    static const char kLabel[] = "PCAE key check";
+
+    unsigned char subkey[EVP_MAX_MD_SIZE];
+    unsigned int subkeySize = 0;
+    if (!HMAC(EVP_sha256(), key.data(), static_cast<int>(key.size()),
+              reinterpret_cast<const unsigned char*>(kLabel), sizeof(kLabel) - 1,
+              subkey, &subkeySize))
+        throw makeOpenSslError("Failed to derive key check subkey");
+
+    unsigned char mac[EVP_MAX_MD_SIZE];
+    unsigned int macSize = 0;
+    bool ok = HMAC(EVP_sha256(), subkey, static_cast<int>(subkeySize),
+                   header, headerSize, mac, &macSize) != nullptr;
+    OPENSSL_cleanse(subkey, sizeof(subkey));
+    if (!ok)
+        throw makeOpenSslError("Failed to compute key check");
+
+    std::memcpy(keyCheck, mac, kKeyCheckSize);
+}
+
+static void initGcm(EVP_CIPHER_CTX* context,
+                    bool encrypt,
+                    const std::vector<unsigned char>& key,
+                    const std::vector<unsigned char>& header,
+                    uint32_t chunkIndex,
+                    bool last) {
+    unsigned char nonce[kNonceSize];
+    makeNonce(header, chunkIndex, nonce);
+
+    int ok = encrypt
+        ? EVP_EncryptInit_ex(context, EVP_aes_256_gcm(), nullptr, key.data(), nonce)
+        : EVP_DecryptInit_ex(context, EVP_aes_256_gcm(), nullptr, key.data(), nonce);
+    if (ok != 1)
+        throw makeOpenSslError("Failed to initialize AES-256-GCM");
+
+    const unsigned char lastFlag = last ? 1 : 0;
+    int written = 0;
+    ok = encrypt
+        ? EVP_EncryptUpdate(context, nullptr, &written, header.data(), static_cast<int>(header.size()))
+        : EVP_DecryptUpdate(context, nullptr, &written, header.data(), static_cast<int>(header.size()));
+    if (ok == 1)
+        ok = encrypt
+            ? EVP_EncryptUpdate(context, nullptr, &written, &lastFlag, 1)
+            : EVP_DecryptUpdate(context, nullptr, &written, &lastFlag, 1);
+    if (ok != 1)
+        throw makeOpenSslError("Failed to authenticate chunk header");
+}
+
+// Шифрует блок из length байт: в out записывается шифртекст и за ним тег
+static void sealChunk(const std::vector<unsigned char>& key,
+                      const std::vector<unsigned char>& header,
+                      uint32_t chunkIndex,
+                      bool last,
+                      const unsigned char* in,
+                      size_t length,
+                      unsigned char* out) {
+    CipherContextPool::Lease context(CipherContextPool::shared());
+    initGcm(context.get(), true, key, header, chunkIndex, last);
+
+    int written = 0;
+    int finalWritten = 0;
+    if (EVP_EncryptUpdate(context.get(), out, &written, in, static_cast<int>(length)) != 1)
+        throw makeOpenSslError("Failed to encrypt data");
+
+    if (EVP_EncryptFinal_ex(context.get(), out + written, &finalWritten) != 1)
+        throw makeOpenSslError("Failed to finalize encryption");
+
+    if (EVP_CIPHER_CTX_ctrl(context.get(),
+                            EVP_CTRL_GCM_GET_TAG,
+                            static_cast<int>(kTagSize),
+                            out + length) != 1)
+        throw makeOpenSslError("Failed to get authentication tag");
+}
+
+// Расшифровывает блок (length байт шифртекста, за ними тег) в out; out может
+// совпадать с in.
+// Возвращает false, если блок не прошел проверку подлинности.
+static bool openChunk(const std::vector<unsigned char>& key,
+                      const std::vector<unsigned char>& header,
+                      uint32_t chunkIndex,
+                      bool last,
+                      const unsigned char* in,
+                      size_t length,
+                      unsigned char* out) {
+    CipherContextPool::Lease context(CipherContextPool::shared());
+    initGcm(context.get(), false, key, header, chunkIndex, last);
+
+    // OpenSSL принимает тег только через неконстантный указатель
+    unsigned char tag[kTagSize];
+    std::memcpy(tag, in + length, kTagSize);
+
+    int written = 0;
+    int finalWritten = 0;
+    if (EVP_DecryptUpdate(context.get(), out, &written, in, static_cast<int>(length)) != 1)
+        throw makeOpenSslError("Failed to decrypt data");
+
+    if (EVP_CIPHER_CTX_ctrl(context.get(),
+                            EVP_CTRL_GCM_SET_TAG,
+                            static_cast<int>(kTagSize),
+                            tag) != 1)
+        throw makeOpenSslError("Failed to set authentication tag");
+
+    return EVP_DecryptFinal_ex(context.get(), out + written, &finalWritten) == 1;
+}
+
+static std::runtime_error chunkAuthenticationError(uint32_t chunkIndex) {
+    if (chunkIndex == 0)
+        return std::runtime_error("Decryption failed (wrong password or corrupted data)");
+    return std::runtime_error("Corrupted data: chunk " + std::to_string(chunkIndex) +
+                              " failed authentication");
+}
+
+// Выполняет task(i) для i в [0, count): одну задачу - в текущем потоке,
+// несколько - параллельно в пуле
+template <typename Task>
+static void runChunks(ThreadPool& pool, size_t count, const Task& task) {
+    if (count == 1) {
+        task(0);
+        return;
+    }
+
+    std::vector<std::future<void>> futures;
+    futures.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+        futures.push_back(pool.submit([&task, i]() { task(i); }));
+    waitAll(futures);
+}
+
+ChunkedEncryptor::ChunkedEncryptor(const CryptoKey& key,
+                                   Output output,
+                                   size_t chunkSize)
+    : ChunkedEncryptor(key, std::move(output), chunkSize, ThreadPool::shared())
+{
+}
+
+ChunkedEncryptor::ChunkedEncryptor(const CryptoKey& key,
+                                   Output output,
+                                   size_t chunkSize,
+                                   ThreadPool& pool)
+    : key(key.key),
+      output(std::move(output)),
+      chunkSize(chunkSize),
+      pool(pool),
+      batchChunks(pool.size()),
+      header(kHeaderSize)
+{
+    if (this->key.size() != kKeySize)
+        throw std::invalid_argument("AES-256 key must be 32 bytes");
+    if (chunkSize == 0 || chunkSize > kMaxChunkSize)
+        throw std::invalid_argument("Invalid encryption chunk size");
+    if (key.params.iterations != 0 && key.params.salt.size() != CryptoService::kSaltSize)
+        throw std::invalid_argument("Invalid key derivation parameters");
+
+    std::memcpy(header.data(), kMagic, sizeof(kMagic));
+    putUInt32(header.data() + 4, kVersion);
+    putUInt32(header.data() + 8, static_cast<uint32_t>(chunkSize));
+    if (RAND_bytes(header.data() + 12, static_cast<int>(kNoncePrefixSize)) != 1)
+        throw makeOpenSslError("Failed to generate nonce");
+    putUInt32(header.data() + kBaseHeaderSize, key.params.iterations);
+    if (key.params.iterations != 0)
+        std::memcpy(header.data() + kBaseHeaderSize + sizeof(uint32_t),
+                    key.params.salt.data(),
+                    CryptoService::kSaltSize);
+    computeKeyCheck(this->key,
+                    header.data(),
+                    kHeaderSize - kKeyCheckSize,
+                    header.data() + kHeaderSize - kKeyCheckSize);
+
+    // Буферы пачки растут по мере записи: короткий поток (запись журнала)
+    // не занимает batchChunks полных блоков
+    this->output(header.data(), header.size());
+}
+
+void ChunkedEncryptor::write(const unsigned char* data, size_t size) {
+    if (finished)
+        throw std::logic_error("Encryption stream is already finished");
+
+    const size_t batchSize = batchChunks * chunkSize;
+    while (size > 0) {
+        size_t take = std::min(size, batchSize - pending.size());
+        pending.insert(pending.end(), data, data + take);
+        data += take;
+        size -= take;
+
+        if (pending.size() == batchSize)
+            sealPending(false);
+    }
+}
+
+void ChunkedEncryptor::finish() {
+    if (finished)
+        return;
+    sealPending(true);
+    finished = true;
+}
+
+std::vector<unsigned char> ChunkedEncryptor::getNoncePrefix() const {
+    return std::vector<unsigned char>(header.begin() + kBaseHeaderSize - kNoncePrefixSize,
+                                      header.begin() + kBaseHeaderSize);
+}
+
+void ChunkedEncryptor::sealPending(bool last) {
+    const size_t fullChunks = pending.size() / chunkSize;
+    const size_t tailSize = pending.size() % chunkSize;
+    const size_t count = fullChunks + (last ? 1 : 0);
+
+    if (count == 0)
+        return;
+    if (static_cast<uint64_t>(chunkIndex) + count > UINT32_MAX)
+        throw std::runtime_error("Too many encryption chunks");
+
+    sealed.resize(count * (chunkSize + kTagSize));
+
+    const uint32_t firstIndex = chunkIndex;
+    runChunks(pool, count, [&](size_t i) {
+        bool isLast = last && i + 1 == count;
+        sealChunk(key, header, firstIndex + static_cast<uint32_t>(i), isLast,
+                  pending.data() + i * chunkSize,
+                  isLast ? tailSize : chunkSize,
+                  sealed.data() + i * (chunkSize + kTagSize));
+    });
+
+    // Все блоки пачки, кроме, возможно, последнего, полные - шифртекст лежит подряд
+    size_t sealedSize = fullChunks * (chunkSize + kTagSize);
+    if (last)
+        sealedSize += tailSize + kTagSize;
+    output(sealed.data(), sealedSize);
+
+    pending.clear();
+    chunkIndex += static_cast<uint32_t>(count);
+}
+
+ChunkedDecryptor::ChunkedDecryptor(std::istream& input)
+    : ChunkedDecryptor(input, ThreadPool::shared())
+{
+}
+
+ChunkedDecryptor::ChunkedDecryptor(std::istream& input, ThreadPool& pool)
+    : input(&input),
+      pool(pool)
+{
+    // Заголовок фиксированного размера: читается целиком и разбирается
+    // так же, как заголовок файла в памяти
+    unsigned char buffer[kHeaderSize];
+    input.read(reinterpret_cast<char*>(buffer), sizeof(buffer));
+    readHeader(buffer, static_cast<size_t>(input.gcount()));
+}
+
+ChunkedDecryptor::ChunkedDecryptor(const unsigned char* data, size_t size)
+    : ChunkedDecryptor(data, size, ThreadPool::shared())
+{
+}
+
+ChunkedDecryptor::ChunkedDecryptor(const unsigned char* data, size_t size, ThreadPool& pool)
+    : pool(pool)
+{
+    readHeader(data, size);
+}
+
+void ChunkedDecryptor::readHeader(const unsigned char* data, size_t size) {
+    if (!hasHeader(data, size))
+        throw std::runtime_error("Encrypted file header is missing or truncated");
+
+    uint32_t version = getUInt32(data + 4);
+    if (version != kVersion)
+        throw std::runtime_error("Unsupported encrypted file version: " + std::to_string(version));
+
+    chunkSize = getUInt32(data + 8);
+    if (chunkSize == 0 || chunkSize > kMaxChunkSize)
+        throw std::runtime_error("Encrypted file header is corrupted");
+
+    if (size < kHeaderSize)
+        throw std::runtime_error("Encrypted file header is missing or truncated");
+    header.assign(data, data + kHeaderSize);
+
+    kdfParams.iterations = getUInt32(data + kBaseHeaderSize);
+    if (kdfParams.iterations > CryptoService::kMaxIterations)
+        throw std::runtime_error("Encrypted file header is corrupted");
+
+    if (kdfParams.iterations != 0) {
+        const unsigned char* salt = data + kBaseHeaderSize + sizeof(uint32_t);
+        kdfParams.salt.assign(salt, salt + CryptoService::kSaltSize);
+    }
+}
+
+void ChunkedDecryptor::unlock(std::vector<unsigned char> key) {
+    if (key.size() != kKeySize)
+        throw std::invalid_argument("AES-256 key must be 32 bytes");
+
+    unsigned char expected[kKeyCheckSize];
+    computeKeyCheck(key, header.data(), kHeaderSize - kKeyCheckSize, expected);
+    if (CRYPTO_memcmp(expected, header.data() + kHeaderSize - kKeyCheckSize, kKeyCheckSize) != 0)
+        throw std::runtime_error("Decryption failed (wrong password)");
+
+    this->key = std::move(key);
+}
+
+std::vector<unsigned char> ChunkedDecryptor::getNoncePrefix() const {
+    return std::vector<unsigned char>(header.begin() + kBaseHeaderSize - kNoncePrefixSize,
+                                      header.begin() + kBaseHeaderSize);
+}
+
+void ChunkedDecryptor::requireKey() const {
+    if (key.empty())
+        throw std::logic_error("Decryption key is not set");
+}
+
+void ChunkedDecryptor::requireEndOfInput() const {
+    if (input->peek() != std::char_traits<char>::eof())
+        throw std::runtime_error("Corrupted data: unexpected bytes after the last chunk");
+}
+
+bool ChunkedDecryptor::readChunk(std::vector<unsigned char>& plaintext) {
+    requireKey();
+    if (!input)
+        throw std::logic_error("Decryptor has no input stream");
+    if (finished)
+        return false;
+
+    sealed.resize(chunkSize + kTagSize);
+    input->read(reinterpret_cast<char*>(sealed.data()), sealed.size());
+    size_t got = static_cast<size_t>(input->gcount());
+    if (got < kTagSize)
+        throw std::runtime_error("Encrypted file is truncated");
+
+    // Полный блок не может быть последним: за ним обязан идти еще один
+    bool last = got < sealed.size();
+    size_t length = got - kTagSize;
+
+    plaintext.resize(length);
+    if (!openChunk(key, header, chunkIndex, last, sealed.data(), length, plaintext.data()))
+        throw chunkAuthenticationError(chunkIndex);
+
+    ++chunkIndex;
+
+    if (last) {
+        finished = true;
+        requireEndOfInput();
+    }
+
+    return true;
+}
+
+void ChunkedDecryptor::readAll(std::vector<unsigned char>& plaintext) {
+    requireKey();
+    if (!input)
+        throw std::logic_error("Decryptor has no input stream");
+
+    const size_t sealedChunkSize = chunkSize + kTagSize;
+    sealed.resize(pool.size() * sealedChunkSize);
+
+    while (!finished) {
+        input->read(reinterpret_cast<char*>(sealed.data()), sealed.size());
+        size_t got = static_cast<size_t>(input->gcount());
+
+        size_t fullChunks = got / sealedChunkSize;
+        size_t tailSize = got % sealedChunkSize;
+        bool last = got < sealed.size();
+
+        // Последний блок всегда неполный, минимум - один тег
+        if (last && tailSize < kTagSize)
+            throw std::runtime_error("Encrypted file is truncated");
+
+        size_t count = fullChunks + (last ? 1 : 0);
+        if (static_cast<uint64_t>(chunkIndex) + count > UINT32_MAX)
+            throw std::runtime_error("Encrypted file header is corrupted");
+
+        size_t base = plaintext.size();
+        plaintext.resize(base + fullChunks * chunkSize + (last ? tailSize - kTagSize : 0));
+
+        std::vector<char> authenticated(count, 0);
+        const uint32_t firstIndex = chunkIndex;
+        runChunks(pool, count, [&](size_t i) {
+            bool isLast = last && i + 1 == count;
+            authenticated[i] = openChunk(key, header, firstIndex + static_cast<uint32_t>(i), isLast,
+                                         sealed.data() + i * sealedChunkSize,
+                                         isLast ? tailSize - kTagSize : chunkSize,
+                                         plaintext.data() + base + i * chunkSize);
+        });
+
+        for (size_t i = 0; i < count; ++i)
+            if (!authenticated[i])
+                throw chunkAuthenticationError(firstIndex + static_cast<uint32_t>(i));
+
+        chunkIndex += static_cast<uint32_t>(count);
+        finished = last;
+    }
+
+    requireEndOfInput();
+}
+
+size_t ChunkedDecryptor::decryptInPlace(unsigned char* data, size_t size) {
+    requireKey();
+
+    const size_t sealedChunkSize = chunkSize + kTagSize;
+    const size_t fullChunks = size / sealedChunkSize;
+    const size_t tailSize = size % sealedChunkSize;
+
+    // Последний блок всегда неполный, минимум - один тег
+    if (tailSize < kTagSize)
+        throw std::runtime_error("Encrypted file is truncated");
+    if (fullChunks >= UINT32_MAX)
+        throw std::runtime_error("Encrypted file header is corrupted");
+
+    const size_t count = fullChunks + 1;
+
+    // Каждый блок расшифровывается поверх собственного шифртекста, поэтому
+    // блоки можно обрабатывать параллельно
+    std::vector<char> authenticated(count, 0);
+    runChunks(pool, count, [&](size_t i) {
+        bool isLast = i + 1 == count;
+        unsigned char* chunk = data + i * sealedChunkSize;
+        authenticated[i] = openChunk(key, header, static_cast<uint32_t>(i), isLast,
+                                     chunk,
+                                     isLast ? tailSize - kTagSize : chunkSize,
+                                     chunk);
+    });
+
+    for (size_t i = 0; i < count; ++i)
+        if (!authenticated[i])
+            throw chunkAuthenticationError(static_cast<uint32_t>(i));
+
+    // Убираем теги между блоками; сдвиг только к началу, порядок - по возрастанию
+    for (size_t i = 1; i < count; ++i) {
+        size_t length = i + 1 == count ? tailSize - kTagSize : chunkSize;
+        std::memmove(data + i * chunkSize, data + i * sealedChunkSize, length);
+    }
+
+    return fullChunks * chunkSize + tailSize - kTagSize;
+}
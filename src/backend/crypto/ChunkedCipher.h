@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "CryptoService.h"
+
+class ThreadPool;
+
+// Потоковое шифрование файла базы блоками AES-256-GCM.
+//
+// Заголовок (он же дополнительные данные AAD каждого блока):
+//   magic[4]        "PCAE"
+//   version         uint32
+//   chunkSize       uint32  - размер открытого текста полного блока
+//   noncePrefix[8]  случайный на каждый файл
+//   iterations      uint32  - параметры PBKDF2 (0 - SHA-256 без соли)
+//   salt[16]
+//   keyCheck[16]    HMAC-SHA256 предыдущих полей на подключе, выведенном из
+//                   ключа; неверный пароль отклоняется по нему сразу после
+//                   чтения заголовка
+// Далее блоки: шифртекст + тег[16]. Nonce блока = noncePrefix || номер блока
+// (uint32, big-endian), в AAD добавляется признак последнего блока. Все блоки,
+// кроме последнего, полные; последний всегда короче chunkSize (может быть
+// пустым), поэтому обрезка файла по границе блока тоже обнаруживается.
+//
+// Блоки независимы, поэтому шифруются и расшифровываются пачками параллельно
+// в пуле потоков; порядок блоков в файле при этом сохраняется.
+namespace chunked_cipher {
+
+const unsigned char kMagic[4] = { 'P', 'C', 'A', 'E' };
+const uint32_t kVersion = 1;
+const size_t kDefaultChunkSize = 1 << 20;
+const size_t kMaxChunkSize = 64 << 20;
+const size_t kKeySize = 32;
+const size_t kNoncePrefixSize = 8;
+const size_t kNonceSize = 12;
+const size_t kTagSize = 16;
+const size_t kKeyCheckSize = 16;
+const size_t kBaseHeaderSize = sizeof(kMagic) + 2 * sizeof(uint32_t) + kNoncePrefixSize;
+const size_t kKdfParamsSize = sizeof(uint32_t) + CryptoService::kSaltSize;
+const size_t kHeaderSize = kBaseHeaderSize + kKdfParamsSize + kKeyCheckSize;
+
+bool hasHeader(const unsigned char* data, size_t size);
+
+}
+
+class ChunkedEncryptor {
+public:
+    using Output = std::function<void(const unsigned char*, size_t)>;
+
+    ChunkedEncryptor(const CryptoKey& key,
+                     Output output,
+                     size_t chunkSize = chunked_cipher::kDefaultChunkSize);
+    ChunkedEncryptor(const CryptoKey& key,
+                     Output output,
+                     size_t chunkSize,
+                     ThreadPool& pool);
+
+    void write(const unsigned char* data, size_t size);
+
+    // Шифрует и отдает последний (неполный) блок; после этого write недопустим
+    void finish();
+
+    // Случайный префикс nonce - уникален для каждого записанного файла
+    std::vector<unsigned char> getNoncePrefix() const;
+
+private:
+    // Шифрует накопленные блоки; при last последний из них помечается финальным
+    void sealPending(bool last);
+
+    std::vector<unsigned char> key;
+    Output output;
+    size_t chunkSize;
+    ThreadPool& pool;
+    size_t batchChunks;
+    std::vector<unsigned char> header;
+    std::vector<unsigned char> pending;
+    std::vector<unsigned char> sealed;
+    uint32_t chunkIndex = 0;
+    bool finished = false;
+};
+
+class ChunkedDecryptor {
+public:
+    // Читает и проверяет заголовок из потока; блоки затем читаются
+    // по одному (readChunk) или все сразу (readAll) без загрузки файла целиком
+    explicit ChunkedDecryptor(std::istream& input);
+    ChunkedDecryptor(std::istream& input, ThreadPool& pool);
+
+    // Разбирает заголовок файла, уже прочитанного в память целиком;
+    // блоки затем расшифровываются через decryptInPlace
+    ChunkedDecryptor(const unsigned char* data, size_t size);
+    ChunkedDecryptor(const unsigned char* data, size_t size, ThreadPool& pool);
+
+    // Параметры, из которых выработан ключ файла
+    const KdfParams& getKdfParams() const { return kdfParams; }
+
+    // Проверяет ключ по контрольному значению заголовка; до вызова блоки
+    // не читаются. Неверный ключ - исключение.
+    void unlock(std::vector<unsigned char> key);
+
+    // Расшифровывает следующий блок потока в plaintext (заменяя содержимое).
+    // Возвращает false, когда последний блок уже прочитан. Поврежденный блок -
+    // исключение, блоки перед ним к этому моменту уже отданы.
+    bool readChunk(std::vector<unsigned char>& plaintext);
+
+    // Расшифровывает все оставшиеся блоки потока пачками в пуле и дописывает
+    // их в plaintext
+    void readAll(std::vector<unsigned char>& plaintext);
+
+    // Расшифровывает все блоки файла на месте: data - данные сразу после
+    // заголовка. Открытый текст сдвигается к началу data, возвращается его длина.
+    size_t decryptInPlace(unsigned char* data, size_t size);
+
+    size_t getChunkSize() const { return chunkSize; }
+    size_t getHeaderSize() const { return header.size(); }
+    std::vector<unsigned char> getNoncePrefix() const;
+
+private:
+    void readHeader(const unsigned char* data, size_t size);
+    void requireKey() const;
+
+    // Проверяет, что за последним блоком потока ничего нет
+    void requireEndOfInput() const;
+
+    std::vector<unsigned char> key;
+    std::istream* input = nullptr;
+    ThreadPool& pool;
+    size_t chunkSize = 0;
+    KdfParams kdfParams;
+    std::vector<unsigned char> header;
+    std::vector<unsigned char> sealed;
+    uint32_t chunkIndex = 0;
+    bool finished = false;
+};
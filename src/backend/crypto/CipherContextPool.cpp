@@ -0,0 +1,30 @@
+#include "CipherContextPool.h"
+
+CipherContext CipherContextPool::acquire() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!idle.empty()) {
+            CipherContext context = std::move(idle.back());
+            idle.pop_back();
+            return context;
+        }
+    }
+    return makeCipherContext();
+}
+
+void CipherContextPool::release(CipherContext context) {
+    if (!context)
+        return;
+
+    // Ключи и состояние предыдущей операции не должны оставаться в пуле
+    if (EVP_CIPHER_CTX_reset(context.get()) != 1)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    idle.push_back(std::move(context));
+}
+
+CipherContextPool& CipherContextPool::shared() {
+    static CipherContextPool pool;
+    return pool;
+}
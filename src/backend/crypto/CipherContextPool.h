@@ -0,0 +1,36 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "OpenSslUtils.h"
+
+// Пул контекстов EVP_CIPHER_CTX: контексты создаются один раз и
+// переиспользуются между вызовами и потоками.
+class CipherContextPool {
+public:
+    class Lease {
+    public:
+        explicit Lease(CipherContextPool& pool)
+            : pool(pool), context(pool.acquire()) {}
+        ~Lease() { pool.release(std::move(context)); }
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        EVP_CIPHER_CTX* get() const { return context.get(); }
+
+    private:
+        CipherContextPool& pool;
+        CipherContext context;
+    };
+
+    CipherContext acquire();
+    void release(CipherContext context);
+
+    static CipherContextPool& shared();
+
+private:
+    std::mutex mutex;
+    std::vector<CipherContext> idle;
+};
@@ -1,14 +1,44 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <string>
 
+// Параметры выработки ключа из пароля; хранятся в заголовке файла
+struct KdfParams {
+    uint32_t iterations = 0;            // 0 - устаревший SHA-256 без соли
+    std::vector<unsigned char> salt;
+};
+
+// Ключ AES-256 вместе с параметрами, из которых он получен
+struct CryptoKey {
+    KdfParams params;
+    std::vector<unsigned char> key;
+};
+
 class CryptoService {
 public:
-    static std::vector<unsigned char> encrypt(
-        const std::vector<unsigned char>& data,
-        const std::string& password);
+    // PBKDF2-HMAC-SHA256; 600000 итераций - около 0.2 с на одно ядро
+    static constexpr uint32_t kDefaultIterations = 600000;
+    static constexpr uint32_t kMaxIterations = 10000000;
+    static constexpr size_t kSaltSize = 16;
+
+    // Новые параметры со случайной солью
+    static KdfParams makeKdfParams(uint32_t iterations = kDefaultIterations);
 
+    // Ключ AES-256 из пароля: PBKDF2 с солью из params,
+    // при iterations == 0 - устаревший SHA256(password)
+    static CryptoKey deriveKey(const std::string& password, const KdfParams& params);
+
+    // Устаревший формат: IV + AES-256-CBC над всем содержимым. Остался только
+    // для чтения старых файлов; новые файлы пишутся через ChunkedEncryptor.
     static std::vector<unsigned char> decrypt(
         const std::vector<unsigned char>& data,
         const std::string& password);
+
+    // Расшифровывает на месте: открытый текст кладется в начало data,
+    // возвращается его длина
+    static size_t decrypt(unsigned char* data,
+                          size_t size,
+                          const std::string& password);
 };
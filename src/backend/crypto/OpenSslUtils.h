@@ -0,0 +1,37 @@
+#pragma once
+
+#include <openssl/err.h>
+#include <openssl/evp.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+inline std::runtime_error makeOpenSslError(const std::string& prefix) {
+    unsigned long errorCode = ERR_get_error();
+    char buffer[256] = {};
+    if (errorCode != 0)
+        ERR_error_string_n(errorCode, buffer, sizeof(buffer));
+
+    std::string message = prefix;
+    if (errorCode != 0) {
+        message += ": ";
+        message += buffer;
+    }
+    return std::runtime_error(message);
+}
+
+struct CipherContextDeleter {
+    void operator()(EVP_CIPHER_CTX* context) const {
+        EVP_CIPHER_CTX_free(context);
+    }
+};
+
+using CipherContext = std::unique_ptr<EVP_CIPHER_CTX, CipherContextDeleter>;
+
+inline CipherContext makeCipherContext() {
+    CipherContext context(EVP_CIPHER_CTX_new());
+    if (!context)
+        throw makeOpenSslError("Failed to create OpenSSL cipher context");
+    return context;
+}
@@ -1,23 +1,31 @@
 #pragma once
 #include <string>
+#include "../utils/DateUtils.h"
+#include "../utils/InternedString.h"
 
+// Поля InternedString - значения с малым числом вариантов, хранятся в общем словаре
 struct Computer {
     int id;
     std::string inventoryNumber;
     std::string serialNumber;
-    std::string manufacturer;
+    InternedString manufacturer;
     std::string model;
     std::string cpuModel;
-    std::string chipset;
+    InternedString chipset;
 
     int ramSize;
-    std::string storageType;
+    InternedString storageType;
     int storageSize;
 
-    std::string roomNumber;
-    std::string condition;
+    InternedString roomNumber;
+    InternedString condition;
 
     std::string commissioningDate;
     std::string lastMaintenanceDate;
     std::string warrantyExpirationDate;
+
+    // Даты выше, разобранные Database при добавлении, изменении и загрузке
+    date_utils::DayNumber commissioningDay = date_utils::kNoDate;
+    date_utils::DayNumber lastMaintenanceDay = date_utils::kNoDate;
+    date_utils::DayNumber warrantyExpirationDay = date_utils::kNoDate;
 };
@@ -1,20 +1,26 @@
 #pragma once
 #include <string>
 #include <optional>
+#include "../utils/DateUtils.h"
+#include "../utils/InternedString.h"
 
+// Поля InternedString - значения с малым числом вариантов, хранятся в общем словаре
 struct Employee {
     int id;
-    std::string institute;
-    std::string department;
+    InternedString institute;
+    InternedString department;
     std::string lastName;
     std::string initials;
-    std::string position;
+    InternedString position;
 
     std::string phone;
     std::string email;
     std::string employmentDate;
 
-    std::string status;
+    InternedString status;
 
     std::optional<int> computerId;
+
+    // employmentDate, разобранная Database при добавлении, изменении и загрузке
+    date_utils::DayNumber employmentDay = date_utils::kNoDate;
 };
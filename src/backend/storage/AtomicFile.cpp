@@ -0,0 +1,90 @@
+#include "AtomicFile.h"
+
+#include <filesystem>
+#include <stdexcept>
+#include <system_error>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+void syncFile(std::FILE* file) {
+    if (std::fflush(file) != 0)
+        throw std::runtime_error("Failed to flush file");
+
+#ifdef _WIN32
+    if (_commit(_fileno(file)) != 0)
+        throw std::runtime_error("Failed to sync file to disk");
+#else
+    if (fsync(fileno(file)) != 0)
+        throw std::runtime_error("Failed to sync file to disk");
+#endif
+}
+
+// Переименование в POSIX становится надежным только после fsync каталога;
+// в Windows это обеспечивает сама файловая система
+static void syncDirectoryOf(const std::string& path) {
+#ifndef _WIN32
+    std::filesystem::path directory = std::filesystem::path(path).parent_path();
+    if (directory.empty())
+        directory = ".";
+
+    int fd = open(directory.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+    fsync(fd);
+    close(fd);
+#else
+    (void)path;
+#endif
+}
+
+AtomicFileWriter::AtomicFileWriter(const std::string& path)
+    : path(path),
+      tempPath(path + ".tmp")
+{
+    file = std::fopen(tempPath.c_str(), "wb");
+    if (!file)
+        throw std::runtime_error("Cannot open file for writing");
+}
+
+AtomicFileWriter::~AtomicFileWriter() {
+    if (file) {
+        std::fclose(file);
+        std::remove(tempPath.c_str());
+    }
+}
+
+void AtomicFileWriter::write(const unsigned char* data, size_t size) {
+    if (!file)
+        throw std::logic_error("File is already committed");
+
+    if (std::fwrite(data, 1, size, file) != size)
+        throw std::runtime_error("Failed to write database file");
+}
+
+void AtomicFileWriter::commit() {
+    if (!file)
+        throw std::logic_error("File is already committed");
+
+    syncFile(file);
+
+    std::FILE* written = file;
+    file = nullptr;
+    if (std::fclose(written) != 0) {
+        std::remove(tempPath.c_str());
+        throw std::runtime_error("Failed to write database file");
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+    if (error) {
+        std::remove(tempPath.c_str());
+        throw std::runtime_error("Failed to replace database file: " + error.message());
+    }
+
+    syncDirectoryOf(path);
+}
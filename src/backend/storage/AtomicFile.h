@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+// Сбрасывает данные файла на диск (fsync / _commit)
+void syncFile(std::FILE* file);
+
+// Запись файла через временный файл в том же каталоге: целевой файл
+// заменяется только в commit() - после fsync, атомарным переименованием.
+// При сбое или исключении до commit() прежний файл остается нетронутым,
+// а временный удаляется деструктором.
+class AtomicFileWriter {
+public:
+    explicit AtomicFileWriter(const std::string& path);
+    ~AtomicFileWriter();
+
+    AtomicFileWriter(const AtomicFileWriter&) = delete;
+    AtomicFileWriter& operator=(const AtomicFileWriter&) = delete;
+
+    void write(const unsigned char* data, size_t size);
+
+    void commit();
+
+private:
+    std::string path;
+    std::string tempPath;
+    std::FILE* file = nullptr;
+};
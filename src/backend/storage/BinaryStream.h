@@ -0,0 +1,152 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Запись полей в заранее выделенный буфер нужного размера (см. Serializer).
+// Если задан output, буфер работает как промежуточный: при заполнении его
+// содержимое отдается в output, и запись продолжается с начала буфера.
+class BinaryWriter {
+public:
+    using Output = std::function<void(const unsigned char*, size_t)>;
+
+private:
+    unsigned char* data;
+    size_t size;
+    size_t position = 0;
+    size_t flushed = 0;
+    Output output;
+
+    void writeRaw(const void* source, size_t length) {
+        if (length > size - position) {
+            if (!output)
+                throw std::logic_error("Буфер сериализации меньше записываемых данных");
+            flush();
+            if (length > size) {
+                output(static_cast<const unsigned char*>(source), length);
+                flushed += length;
+                return;
+            }
+        }
+        std::memcpy(data + position, source, length);
+        position += length;
+    }
+
+public:
+    BinaryWriter(unsigned char* data, size_t size, Output output = nullptr)
+        : data(data), size(size), output(std::move(output)) {}
+
+    void flush() {
+        if (output && position > 0) {
+            output(data, position);
+            flushed += position;
+            position = 0;
+        }
+    }
+
+    void writeInt(int value) { writeRaw(&value, sizeof(value)); }
+    void writeUInt32(uint32_t value) { writeRaw(&value, sizeof(value)); }
+    void writeUInt64(uint64_t value) { writeRaw(&value, sizeof(value)); }
+    void writeBytes(const void* source, size_t length) { writeRaw(source, length); }
+    void writeSize(size_t value) { writeRaw(&value, sizeof(value)); }
+    void writeBool(bool value) {
+        unsigned char byte = value ? 1 : 0;
+        writeRaw(&byte, sizeof(byte));
+    }
+    void writeString(const std::string& value) {
+        writeSize(value.size());
+        writeRaw(value.data(), value.size());
+    }
+
+    size_t written() const { return flushed + position; }
+
+    static size_t stringSize(const std::string& value) {
+        return sizeof(size_t) + value.size();
+    }
+};
+
+// Чтение полей из непрерывного буфера с проверкой границ.
+class BinaryReader {
+private:
+    const unsigned char* data;
+    size_t size;
+    size_t position = 0;
+
+    void readRaw(void* target, size_t length) {
+        require(length);
+        std::memcpy(target, data + position, length);
+        position += length;
+    }
+
+public:
+    BinaryReader(const unsigned char* data, size_t size)
+        : data(data), size(size) {}
+
+    void require(size_t length) const {
+        if (length > size - position)
+            throw std::runtime_error("Данные базы повреждены: неожиданный конец данных");
+    }
+
+    int readInt() {
+        int value;
+        readRaw(&value, sizeof(value));
+        return value;
+    }
+
+    uint32_t readUInt32() {
+        uint32_t value;
+        readRaw(&value, sizeof(value));
+        return value;
+    }
+
+    uint64_t readUInt64() {
+        uint64_t value;
+        readRaw(&value, sizeof(value));
+        return value;
+    }
+
+    void readBytes(void* target, size_t length) { readRaw(target, length); }
+
+    // Указатель на следующие length байт без копирования
+    const unsigned char* readSpan(size_t length) {
+        require(length);
+        const unsigned char* span = data + position;
+        position += length;
+        return span;
+    }
+
+    size_t readSize() {
+        size_t value;
+        readRaw(&value, sizeof(value));
+        return value;
+    }
+
+    bool readBool() {
+        unsigned char byte;
+        readRaw(&byte, sizeof(byte));
+        return byte != 0;
+    }
+
+    // Строка без копирования: представление указывает в буфер чтения
+    std::string_view readStringView() {
+        size_t length = readSize();
+        require(length);
+        std::string_view value(reinterpret_cast<const char*>(data + position), length);
+        position += length;
+        return value;
+    }
+
+    std::string readString() {
+        size_t length = readSize();
+        require(length);
+        std::string value(reinterpret_cast<const char*>(data + position), length);
+        position += length;
+        return value;
+    }
+
+    size_t remaining() const { return size - position; }
+};
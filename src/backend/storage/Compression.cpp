@@ -0,0 +1,361 @@
+#include "Compression.h"
+#include "BinaryStream.h"
+#include "../utils/ThreadPool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <string>
+
+namespace compression {
+
+// Параметры формата блока LZ4
+static const size_t kMinMatch = 4;
+static const size_t kLastLiterals = 5;      // последние байты блока - всегда литералы
+static const size_t kMatchSearchLimit = 12; // совпадение начинается не ближе к концу
+static const size_t kMaxOffset = 65535;
+static const int kHashLog = 16;
+static const size_t kMaxBlockSize = 64 << 20;
+// Один байт блока LZ4 дает не больше 255 байт результата: длиннее
+// исходный блок быть не может
+static const size_t kMaxRatio = 255;
+
+static std::runtime_error corruptedError() {
+    return std::runtime_error("Данные базы повреждены: ошибка распаковки");
+}
+
+static uint32_t read32(const unsigned char* source) {
+    uint32_t value;
+    std::memcpy(&value, source, sizeof(value));
+    return value;
+}
+
+static uint32_t hashSequence(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - kHashLog);
+}
+
+// Продолжение длины после значения 15 в токене: байты по 255 и остаток
+static unsigned char* writeLength(unsigned char* out, size_t length) {
+    while (length >= 255) {
+        *out++ = 255;
+        length -= 255;
+    }
+    *out++ = static_cast<unsigned char>(length);
+    return out;
+}
+
+static size_t readLength(const unsigned char*& in, const unsigned char* end) {
+    size_t length = 0;
+    unsigned char byte;
+    do {
+        if (in == end)
+            throw corruptedError();
+        byte = *in++;
+        length += byte;
+    } while (byte == 255);
+    return length;
+}
+
+// Последовательность: токен, литералы, смещение и длина совпадения.
+// matchLength == 0 - последняя последовательность блока, только литералы.
+static unsigned char* writeSequence(unsigned char* out,
+                                    const unsigned char* literals,
+                                    size_t literalLength,
+                                    size_t offset,
+                                    size_t matchLength) {
+    unsigned char* token = out++;
+    *token = static_cast<unsigned char>(std::min<size_t>(literalLength, 15) << 4);
+    if (literalLength >= 15)
+        out = writeLength(out, literalLength - 15);
+
+    std::memcpy(out, literals, literalLength);
+    out += literalLength;
+
+    if (matchLength == 0)
+        return out;
+
+    out[0] = static_cast<unsigned char>(offset);
+    out[1] = static_cast<unsigned char>(offset >> 8);
+    out += 2;
+
+    size_t code = matchLength - kMinMatch;
+    *token |= static_cast<unsigned char>(std::min<size_t>(code, 15));
+    if (code >= 15)
+        out = writeLength(out, code - 15);
+    return out;
+}
+
+bool hasHeader(const unsigned char* data, size_t size) {
+    return size >= kHeaderSize && std::memcmp(data, kMagic, sizeof(kMagic)) == 0;
+}
+
+size_t lz4Bound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+size_t lz4Compress(const unsigned char* src, size_t size, unsigned char* dst) {
+    unsigned char* out = dst;
+    size_t anchor = 0;
+
+    if (size > kMatchSearchLimit) {
+        // Последняя позиция, где встречалась каждая 4-байтовая последовательность
+        std::vector<uint32_t> table(size_t(1) << kHashLog, 0);
+        const size_t matchLimit = size - kLastLiterals;
+        const size_t searchLimit = size - kMatchSearchLimit;
+
+        size_t position = 0;
+        while (position < searchLimit) {
+            uint32_t sequence = read32(src + position);
+            uint32_t& slot = table[hashSequence(sequence)];
+            size_t candidate = slot;
+            slot = static_cast<uint32_t>(position);
+
+            if (candidate >= position ||
+                position - candidate > kMaxOffset ||
+                read32(src + candidate) != sequence) {
+                // На несжимаемых участках шаг поиска постепенно растет
+                position += 1 + ((position - anchor) >> 6);
+                continue;
+            }
+
+            while (position > anchor && candidate > 0 && src[position - 1] == src[candidate - 1]) {
+                --position;
+                --candidate;
+            }
+
+            size_t length = kMinMatch;
+            while (position + length < matchLimit && src[position + length] == src[candidate + length])
+                ++length;
+
+            out = writeSequence(out, src + anchor, position - anchor, position - candidate, length);
+            position += length;
+            anchor = position;
+        }
+    }
+
+    out = writeSequence(out, src + anchor, size - anchor, 0, 0);
+    return static_cast<size_t>(out - dst);
+}
+
+void lz4Decompress(const unsigned char* src, size_t size, unsigned char* dst, size_t rawSize) {
+    const unsigned char* in = src;
+    const unsigned char* end = src + size;
+    unsigned char* out = dst;
+    unsigned char* outEnd = dst + rawSize;
+
+    for (;;) {
+        if (in == end)
+            throw corruptedError();
+
+        unsigned char token = *in++;
+        size_t literalLength = token >> 4;
+        if (literalLength == 15)
+            literalLength += readLength(in, end);
+
+        if (literalLength > static_cast<size_t>(end - in) ||
+            literalLength > static_cast<size_t>(outEnd - out))
+            throw corruptedError();
+
+        std::memcpy(out, in, literalLength);
+        in += literalLength;
+        out += literalLength;
+
+        if (in == end)
+            break;
+
+        if (end - in < 2)
+            throw corruptedError();
+        size_t offset = in[0] | (static_cast<size_t>(in[1]) << 8);
+        in += 2;
+        if (offset == 0 || offset > static_cast<size_t>(out - dst))
+            throw corruptedError();
+
+        size_t matchLength = token & 15;
+        if (matchLength == 15)
+            matchLength += readLength(in, end);
+        matchLength += kMinMatch;
+        if (matchLength > static_cast<size_t>(outEnd - out))
+            throw corruptedError();
+
+        // Совпадение может перекрывать само себя: копируем кусками, которые
+        // удваиваются по мере того, как повторяющийся фрагмент растет
+        const unsigned char* match = out - offset;
+        while (matchLength > 0) {
+            size_t step = std::min(static_cast<size_t>(out - match), matchLength);
+            std::memcpy(out, match, step);
+            out += step;
+            matchLength -= step;
+        }
+    }
+
+    if (out != outEnd)
+        throw corruptedError();
+}
+
+std::vector<unsigned char> decompress(const unsigned char* data, size_t size) {
+    return decompress(data, size, ThreadPool::shared());
+}
+
+std::vector<unsigned char> decompress(const unsigned char* data, size_t size, ThreadPool& pool) {
+    if (!hasHeader(data, size))
+        throw std::runtime_error("Данные базы повреждены: отсутствует заголовок сжатия");
+
+    BinaryReader in(data, size);
+    in.readSpan(sizeof(kMagic));
+
+    uint32_t version = in.readUInt32();
+    if (version != kVersion)
+        throw std::runtime_error("Неподдерживаемая версия сжатия: " + std::to_string(version));
+
+    uint32_t codec = in.readUInt32();
+    if (codec != static_cast<uint32_t>(Codec::Lz4))
+        throw std::runtime_error("Неизвестный алгоритм сжатия: " + std::to_string(codec));
+
+    size_t blockSize = in.readUInt32();
+    if (blockSize == 0 || blockSize > kMaxBlockSize)
+        throw corruptedError();
+
+    struct Block {
+        const unsigned char* data;
+        size_t storedSize;
+        size_t rawSize;
+        size_t offset;
+    };
+
+    // Размеры блоков из файла проверяются до выделения памяти: все блоки,
+    // кроме последнего, полные, и ни один не распаковывается больше, чем
+    // позволяет формат LZ4. Итог не превышает число блоков * blockSize
+    // и kMaxRatio * размер данных
+    std::vector<Block> blocks;
+    size_t total = 0;
+    while (in.remaining() > 0) {
+        if (!blocks.empty() && blocks.back().rawSize != blockSize)
+            throw corruptedError();
+
+        Block block;
+        block.rawSize = in.readUInt32();
+        block.storedSize = in.readUInt32();
+        if (block.rawSize == 0 || block.rawSize > blockSize || block.storedSize > block.rawSize ||
+            block.rawSize / kMaxRatio > block.storedSize)
+            throw corruptedError();
+
+        block.data = in.readSpan(block.storedSize);
+        block.offset = total;
+        total += block.rawSize;
+        blocks.push_back(block);
+    }
+
+    std::vector<unsigned char> raw(total);
+
+    std::vector<std::future<void>> futures;
+    futures.reserve(blocks.size());
+    for (const Block& block : blocks)
+        futures.push_back(pool.submit([&raw, block]() {
+            unsigned char* target = raw.data() + block.offset;
+            if (block.storedSize == block.rawSize)
+                std::memcpy(target, block.data, block.rawSize);
+            else
+                lz4Decompress(block.data, block.storedSize, target, block.rawSize);
+        }));
+    waitAll(futures);
+
+    return raw;
+}
+
+}
+
+using namespace compression;
+
+static size_t slotSize() {
+    return kBlockHeaderSize + lz4Bound(kBlockSize);
+}
+
+CompressingWriter::CompressingWriter(Codec codec, Output output)
+    : CompressingWriter(codec, std::move(output), ThreadPool::shared())
+{
+}
+
+CompressingWriter::CompressingWriter(Codec codec, Output output, ThreadPool& pool)
+    : codec(codec),
+      output(std::move(output)),
+      pool(pool),
+      batchBlocks(pool.size()),
+      compressedSizes(batchBlocks)
+{
+    if (codec != Codec::Lz4)
+        throw std::invalid_argument("Неподдерживаемый алгоритм сжатия");
+
+    pending.reserve(batchBlocks * kBlockSize);
+    compressed.resize(batchBlocks * slotSize());
+
+    unsigned char header[kHeaderSize];
+    BinaryWriter writer(header, sizeof(header));
+    writer.writeBytes(kMagic, sizeof(kMagic));
+    writer.writeUInt32(kVersion);
+    writer.writeUInt32(static_cast<uint32_t>(codec));
+    writer.writeUInt32(static_cast<uint32_t>(kBlockSize));
+    this->output(header, sizeof(header));
+}
+
+void CompressingWriter::write(const unsigned char* data, size_t size) {
+    if (finished)
+        throw std::logic_error("Поток сжатия уже завершен");
+
+    const size_t batchSize = batchBlocks * kBlockSize;
+    while (size > 0) {
+        size_t take = std::min(size, batchSize - pending.size());
+        pending.insert(pending.end(), data, data + take);
+        data += take;
+        size -= take;
+
+        if (pending.size() == batchSize)
+            compressPending();
+    }
+}
+
+void CompressingWriter::finish() {
+    if (finished)
+        return;
+    compressPending();
+    finished = true;
+}
+
+void CompressingWriter::compressPending() {
+    const size_t count = (pending.size() + kBlockSize - 1) / kBlockSize;
+    if (count == 0)
+        return;
+
+    auto compressBlock = [this](size_t i) {
+        const unsigned char* source = pending.data() + i * kBlockSize;
+        size_t rawSize = std::min(kBlockSize, pending.size() - i * kBlockSize);
+        unsigned char* slot = compressed.data() + i * slotSize();
+
+        size_t storedSize = lz4Compress(source, rawSize, slot + kBlockHeaderSize);
+        if (storedSize >= rawSize) {
+            // Несжимаемый блок хранится как есть
+            std::memcpy(slot + kBlockHeaderSize, source, rawSize);
+            storedSize = rawSize;
+        }
+
+        BinaryWriter writer(slot, kBlockHeaderSize);
+        writer.writeUInt32(static_cast<uint32_t>(rawSize));
+        writer.writeUInt32(static_cast<uint32_t>(storedSize));
+        compressedSizes[i] = kBlockHeaderSize + storedSize;
+    };
+
+    if (count == 1) {
+        compressBlock(0);
+    } else {
+        std::vector<std::future<void>> futures;
+        futures.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+            futures.push_back(pool.submit([&compressBlock, i]() { compressBlock(i); }));
+        waitAll(futures);
+    }
+
+    for (size_t i = 0; i < count; ++i)
+        output(compressed.data() + i * slotSize(), compressedSizes[i]);
+
+    pending.clear();
+}
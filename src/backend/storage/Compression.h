@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class ThreadPool;
+
+// Сжатие сериализованной базы перед шифрованием.
+//
+// Формат (все числа - в порядке байт платформы, как в DatabaseFormat):
+//   magic[4]     "PCLZ"
+//   version      uint32
+//   codec        uint32  - Codec
+//   blockSize    uint32  - максимальный размер исходного блока
+// Далее блоки до конца данных:
+//   rawSize      uint32
+//   storedSize   uint32  - storedSize == rawSize: блок хранится без сжатия
+//   data[storedSize]
+// Блоки сжимаются независимо (формат блока LZ4), поэтому упаковка и распаковка
+// идут пачками параллельно в пуле потоков.
+namespace compression {
+
+const unsigned char kMagic[4] = { 'P', 'C', 'L', 'Z' };
+const uint32_t kVersion = 1;
+const size_t kBlockSize = 1 << 20;
+const size_t kHeaderSize = sizeof(kMagic) + 3 * sizeof(uint32_t);
+const size_t kBlockHeaderSize = 2 * sizeof(uint32_t);
+
+enum class Codec : uint32_t {
+    None = 0,   // данные пишутся без обрамления
+    Lz4 = 1
+};
+
+bool hasHeader(const unsigned char* data, size_t size);
+
+// Максимальный размер сжатого блока для size исходных байт
+size_t lz4Bound(size_t size);
+
+// Сжимает блок в dst (не меньше lz4Bound(size) байт), возвращает длину результата
+size_t lz4Compress(const unsigned char* src, size_t size, unsigned char* dst);
+
+// Распаковывает блок ровно в rawSize байт; поврежденные данные - исключение
+void lz4Decompress(const unsigned char* src, size_t size, unsigned char* dst, size_t rawSize);
+
+// Распаковывает данные в формате выше
+std::vector<unsigned char> decompress(const unsigned char* data, size_t size);
+std::vector<unsigned char> decompress(const unsigned char* data, size_t size, ThreadPool& pool);
+
+}
+
+// Потоковая упаковка: принимает данные частями и отдает в output
+// заголовок и сжатые блоки по порядку.
+class CompressingWriter {
+public:
+    using Output = std::function<void(const unsigned char*, size_t)>;
+
+    CompressingWriter(compression::Codec codec, Output output);
+    CompressingWriter(compression::Codec codec, Output output, ThreadPool& pool);
+
+    void write(const unsigned char* data, size_t size);
+
+    // Сжимает и отдает оставшиеся данные
+    void finish();
+
+private:
+    void compressPending();
+
+    compression::Codec codec;
+    Output output;
+    ThreadPool& pool;
+    size_t batchBlocks;
+    std::vector<unsigned char> pending;
+    std::vector<unsigned char> compressed;
+    std::vector<size_t> compressedSizes;
+    bool finished = false;
+};
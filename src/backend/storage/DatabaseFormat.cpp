@@ -0,0 +1,112 @@
+#include "DatabaseFormat.h"
+#include "BinaryStream.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace database_format {
+
+const SectionEntry* Header::findSection(SectionId id) const {
+    for (const auto& section : sections)
+        if (section.id == static_cast<uint32_t>(id))
+            return &section;
+    return nullptr;
+}
+
+bool hasHeader(const unsigned char* data, size_t size) {
+    return size >= kFixedHeaderSize && std::memcmp(data, kMagic, sizeof(kMagic)) == 0;
+}
+
+Header readHeader(const unsigned char* data, size_t size) {
+    if (!hasHeader(data, size))
+        throw std::runtime_error("Данные базы повреждены: отсутствует заголовок");
+
+    BinaryReader in(data, size);
+    unsigned char magic[sizeof(kMagic)];
+    in.readBytes(magic, sizeof(magic));
+
+    Header header;
+    header.formatVersion = in.readUInt32();
+    header.schemaVersion = in.readUInt32();
+
+    if (header.formatVersion != kFormatVersion)
+        throw std::runtime_error("Неподдерживаемая версия формата файла: " +
+                                 std::to_string(header.formatVersion));
+    if (header.schemaVersion > kSchemaVersion)
+        throw std::runtime_error("Файл создан более новой версией программы (схема " +
+                                 std::to_string(header.schemaVersion) + ")");
+
+    uint32_t sectionCount = in.readUInt32();
+    in.require(static_cast<size_t>(sectionCount) * kSectionEntrySize);
+    header.sections.reserve(sectionCount);
+
+    for (uint32_t i = 0; i < sectionCount; ++i) {
+        SectionEntry section;
+        section.id = in.readUInt32();
+        section.offset = in.readUInt64();
+        section.length = in.readUInt64();
+        section.recordCount = in.readUInt64();
+
+        if (section.offset > size || section.length > size - section.offset)
+            throw std::runtime_error("Данные базы повреждены: раздел " +
+                                     std::to_string(section.id) + " выходит за границы файла");
+
+        header.sections.push_back(section);
+    }
+
+    return header;
+}
+
+std::vector<SectionEntry> readChunks(const unsigned char* data,
+                                     const Header& header,
+                                     SectionId section,
+                                     SectionId chunkSection) {
+    std::vector<SectionEntry> chunks;
+
+    const SectionEntry* records = header.findSection(section);
+    if (!records)
+        return chunks;
+
+    const SectionEntry* table = header.findSection(chunkSection);
+    if (!table) {
+        chunks.push_back(*records);
+        return chunks;
+    }
+
+    const std::string corrupted = "Данные базы повреждены: неверное оглавление раздела " +
+                                  std::to_string(records->id);
+
+    if (table->length / kChunkEntrySize < table->recordCount ||
+        table->length != table->recordCount * kChunkEntrySize)
+        throw std::runtime_error(corrupted);
+
+    BinaryReader in(data + table->offset, static_cast<size_t>(table->length));
+    chunks.reserve(static_cast<size_t>(table->recordCount));
+
+    uint64_t expectedOffset = 0;
+    uint64_t totalRecords = 0;
+    for (uint64_t i = 0; i < table->recordCount; ++i) {
+        SectionEntry chunk;
+        chunk.id = records->id;
+        uint64_t offset = in.readUInt64();
+        chunk.length = in.readUInt64();
+        chunk.recordCount = in.readUInt64();
+
+        // Блоки должны идти подряд и целиком покрывать раздел
+        if (offset != expectedOffset || chunk.length > records->length - offset)
+            throw std::runtime_error(corrupted);
+
+        chunk.offset = records->offset + offset;
+        expectedOffset = offset + chunk.length;
+        totalRecords += chunk.recordCount;
+        chunks.push_back(chunk);
+    }
+
+    if (expectedOffset != records->length || totalRecords != records->recordCount)
+        throw std::runtime_error(corrupted);
+
+    return chunks;
+}
+
+}
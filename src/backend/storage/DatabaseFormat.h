@@ -0,0 +1,71 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Формат расшифрованного содержимого файла базы.
+//
+// Заголовок:
+//   magic[4]           "PCDB"
+//   formatVersion      uint32
+//   schemaVersion      uint32
+//   sectionCount       uint32
+//   sectionCount x { id uint32, offset uint64, length uint64, recordCount uint64 }
+// Далее идут разделы; смещения отсчитываются от начала содержимого.
+// Записи внутри раздела кодируются так же, как в исходном формате без заголовка
+// (версия 1). Номера версии в нем нет, поэтому он распознается по отсутствию
+// magic и по-прежнему читается.
+//
+// Для каждого раздела с записями может быть раздел-оглавление блоков
+// (EmployeeChunks/ComputerChunks): recordCount x { offset uint64, length uint64,
+// recordCount uint64 }, смещения относительно начала раздела с записями.
+// Блоки начинаются на границе записи, поэтому декодируются независимо.
+namespace database_format {
+
+const unsigned char kMagic[4] = { 'P', 'C', 'D', 'B' };
+const uint32_t kFormatVersion = 2;
+const uint32_t kSchemaVersion = 1;
+
+enum class SectionId : uint32_t {
+    Employees = 1,
+    Computers = 2,
+    EmployeeChunks = 3,
+    ComputerChunks = 4
+};
+
+// Сколько записей писатель кладет в один блок
+const uint64_t kRecordsPerChunk = 16384;
+
+struct SectionEntry {
+    uint32_t id;
+    uint64_t offset;
+    uint64_t length;
+    uint64_t recordCount;
+};
+
+struct Header {
+    uint32_t formatVersion;
+    uint32_t schemaVersion;
+    std::vector<SectionEntry> sections;
+
+    const SectionEntry* findSection(SectionId id) const;
+};
+
+const size_t kFixedHeaderSize = sizeof(kMagic) + 3 * sizeof(uint32_t);
+const size_t kSectionEntrySize = sizeof(uint32_t) + 3 * sizeof(uint64_t);
+const size_t kChunkEntrySize = 3 * sizeof(uint64_t);
+
+bool hasHeader(const unsigned char* data, size_t size);
+
+// Разбирает и проверяет заголовок: версии и границы всех разделов.
+Header readHeader(const unsigned char* data, size_t size);
+
+// Блоки раздела section в виде SectionEntry с абсолютными смещениями. Если
+// оглавления нет, весь раздел возвращается одним блоком; если нет и раздела -
+// пустой список.
+std::vector<SectionEntry> readChunks(const unsigned char* data,
+                                     const Header& header,
+                                     SectionId section,
+                                     SectionId chunkSection);
+
+}
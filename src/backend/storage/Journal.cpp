@@ -0,0 +1,174 @@
+#include "Journal.h"
+#include "AtomicFile.h"
+#include "BinaryStream.h"
+#include "Serializer.h"
+#include "../crypto/ChunkedCipher.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace journal {
+
+static_assert(kBaseIdSize == chunked_cipher::kNoncePrefixSize,
+              "Journal base id is the nonce prefix of the database file");
+
+static const size_t kEntryPrefixSize = kBaseIdSize + sizeof(uint32_t);
+
+static bool sameParams(const KdfParams& a, const KdfParams& b) {
+    return a.iterations == b.iterations && a.salt == b.salt;
+}
+
+static std::runtime_error corruptedError(const std::string& reason) {
+    return std::runtime_error("Журнал изменений поврежден: " + reason);
+}
+
+std::string pathFor(const std::string& databasePath) {
+    return databasePath + ".journal";
+}
+
+bool needsCompaction(const SnapshotInfo& snapshot) {
+    return snapshot.journalSize > snapshot.baseSize * kCompactionRatio;
+}
+
+void append(const ChangeSet& changes, const CryptoKey& key, SnapshotInfo& snapshot) {
+    if (snapshot.baseId.size() != kBaseIdSize)
+        throw std::logic_error("Журнал не привязан к файлу базы");
+
+    std::vector<unsigned char> body = Serializer::serializeChanges(changes);
+
+    std::vector<unsigned char> entry(kEntryPrefixSize);
+    BinaryWriter prefix(entry.data(), entry.size());
+    prefix.writeBytes(snapshot.baseId.data(), kBaseIdSize);
+    prefix.writeUInt32(snapshot.journalEntries);
+
+    // Запись шифруется одним блоком: последний блок всегда короче chunkSize,
+    // поэтому размер блока берется на байт больше записи
+    size_t chunkSize = std::min(entry.size() + body.size() + 1, chunked_cipher::kDefaultChunkSize);
+
+    std::vector<unsigned char> sealed;
+    ChunkedEncryptor encryptor(key, [&sealed](const unsigned char* data, size_t size) {
+        sealed.insert(sealed.end(), data, data + size);
+    }, chunkSize);
+    encryptor.write(entry.data(), entry.size());
+    encryptor.write(body.data(), body.size());
+    encryptor.finish();
+
+    // Первая запись создает файл заново: старый журнал относится к другой базе
+    bool create = snapshot.journalSize == 0;
+    std::vector<unsigned char> record((create ? kHeaderSize : 0) + sizeof(uint64_t) + sealed.size());
+    BinaryWriter writer(record.data(), record.size());
+
+    if (create) {
+        writer.writeBytes(kMagic, sizeof(kMagic));
+        writer.writeUInt32(kVersion);
+        writer.writeBytes(snapshot.baseId.data(), kBaseIdSize);
+    }
+
+    writer.writeUInt64(sealed.size());
+    writer.writeBytes(sealed.data(), sealed.size());
+
+    std::FILE* out = std::fopen(pathFor(snapshot.path).c_str(), create ? "wb" : "ab");
+    if (!out)
+        throw std::runtime_error("Cannot open journal file for writing");
+
+    // Сохранение считается выполненным, только когда запись дошла до диска
+    bool ok = std::fwrite(record.data(), 1, record.size(), out) == record.size();
+    if (ok) {
+        try {
+            syncFile(out);
+        } catch (...) {
+            std::fclose(out);
+            throw;
+        }
+    }
+    if (std::fclose(out) != 0 || !ok)
+        throw std::runtime_error("Failed to write journal file");
+
+    snapshot.journalSize += record.size();
+    ++snapshot.journalEntries;
+}
+
+std::vector<ChangeSet> read(const std::string& password,
+                            const CryptoKey& key,
+                            SnapshotInfo& snapshot) {
+    snapshot.journalSize = 0;
+    snapshot.journalEntries = 0;
+
+    std::vector<ChangeSet> entries;
+    if (snapshot.baseId.size() != kBaseIdSize)
+        return entries;
+
+    const std::string path = pathFor(snapshot.path);
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in.is_open())
+        return entries;
+
+    std::vector<unsigned char> buffer(static_cast<size_t>(in.tellg()));
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+    if (static_cast<size_t>(in.gcount()) != buffer.size())
+        throw std::runtime_error("Failed to read journal file");
+    in.close();
+
+    // Файл, не успевший получить заголовок, равносилен отсутствию журнала
+    if (buffer.size() < kHeaderSize)
+        return entries;
+
+    BinaryReader header(buffer.data(), kHeaderSize);
+    if (std::memcmp(header.readSpan(sizeof(kMagic)), kMagic, sizeof(kMagic)) != 0)
+        throw corruptedError("отсутствует заголовок");
+
+    uint32_t version = header.readUInt32();
+    if (version != kVersion)
+        throw std::runtime_error("Неподдерживаемая версия журнала изменений: " + std::to_string(version));
+
+    if (std::memcmp(header.readSpan(kBaseIdSize), snapshot.baseId.data(), kBaseIdSize) != 0)
+        return entries;
+
+    CryptoKey entryKey = key;
+    size_t position = kHeaderSize;
+
+    while (buffer.size() - position >= sizeof(uint64_t)) {
+        uint64_t length = BinaryReader(buffer.data() + position, sizeof(uint64_t)).readUInt64();
+        if (length > buffer.size() - position - sizeof(length))
+            break;
+
+        unsigned char* sealed = buffer.data() + position + sizeof(length);
+        ChunkedDecryptor decryptor(sealed, static_cast<size_t>(length));
+        if (!sameParams(decryptor.getKdfParams(), entryKey.params))
+            entryKey = CryptoService::deriveKey(password, decryptor.getKdfParams());
+        decryptor.unlock(entryKey.key);
+
+        unsigned char* payload = sealed + decryptor.getHeaderSize();
+        size_t payloadSize = decryptor.decryptInPlace(
+            payload, static_cast<size_t>(length) - decryptor.getHeaderSize());
+
+        BinaryReader prefix(payload, payloadSize);
+        if (std::memcmp(prefix.readSpan(kBaseIdSize), snapshot.baseId.data(), kBaseIdSize) != 0)
+            throw corruptedError("запись относится к другому файлу базы");
+        if (prefix.readUInt32() != entries.size())
+            throw corruptedError("нарушен порядок записей");
+
+        entries.push_back(Serializer::deserializeChanges(payload + kEntryPrefixSize,
+                                                         payloadSize - kEntryPrefixSize));
+        position += sizeof(length) + static_cast<size_t>(length);
+    }
+
+    // Недописанный хвост отрезается, чтобы следующие записи шли сразу за целыми
+    if (position < buffer.size())
+        std::filesystem::resize_file(path, position);
+
+    snapshot.journalSize = position;
+    snapshot.journalEntries = static_cast<uint32_t>(entries.size());
+    return entries;
+}
+
+void remove(const std::string& databasePath) {
+    std::remove(pathFor(databasePath).c_str());
+}
+
+}
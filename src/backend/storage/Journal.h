@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../core/ChangeSet.h"
+#include "../crypto/CryptoService.h"
+
+// Сведения о последнем полном сохранении базы: по ним изменения дописываются
+// в журнал, а не перезаписывается весь файл
+struct SnapshotInfo {
+    std::string path;
+    std::vector<unsigned char> baseId;  // префикс nonce файла базы; пусто - журнал не ведется
+    uint64_t baseSize = 0;
+    uint64_t journalSize = 0;           // вместе с заголовком; 0 - журнала нет
+    uint32_t journalEntries = 0;
+};
+
+// Журнал изменений рядом с файлом базы (path + ".journal").
+//
+// Заголовок:
+//   magic[4]   "PCJL"
+//   version    uint32
+//   baseId[8]  префикс nonce файла базы, к которому относится журнал
+// Далее записи до конца файла:
+//   length     uint64
+//   data[length] - зашифрованные ChunkedEncryptor данные:
+//       baseId[8], номер записи uint32, ChangeSet (Serializer::serializeChanges)
+// Журнал другой версии базы (baseId не совпадает) игнорируется, недописанная
+// последняя запись (сбой во время сохранения) отбрасывается.
+namespace journal {
+
+const unsigned char kMagic[4] = { 'P', 'C', 'J', 'L' };
+const uint32_t kVersion = 1;
+const size_t kBaseIdSize = 8;
+const size_t kHeaderSize = sizeof(kMagic) + sizeof(uint32_t) + kBaseIdSize;
+
+// Журнал больше этой доли файла базы сворачивается в новый файл базы
+const double kCompactionRatio = 0.5;
+
+std::string pathFor(const std::string& databasePath);
+
+bool needsCompaction(const SnapshotInfo& snapshot);
+
+// Дописывает набор изменений и обновляет journalSize/journalEntries
+void append(const ChangeSet& changes, const CryptoKey& key, SnapshotInfo& snapshot);
+
+// Читает записи журнала базы snapshot; записи, зашифрованные с другими
+// параметрами KDF, расшифровываются ключом, выработанным из password
+std::vector<ChangeSet> read(const std::string& password,
+                            const CryptoKey& key,
+                            SnapshotInfo& snapshot);
+
+void remove(const std::string& databasePath);
+
+}
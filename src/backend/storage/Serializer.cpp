@@ -1,147 +1,389 @@
 #include "Serializer.h"
-#include <sstream>
+#include "BinaryStream.h"
+#include "DatabaseFormat.h"
+#include <algorithm>
 #include <stdexcept>
+#include <string>
+
+// Минимальный размер записи в потоке (все строки пустые): используется, чтобы
+// не резервировать память по счетчику из поврежденного файла
+static const size_t kMinEmployeeRecordSize = sizeof(int) + 9 * sizeof(size_t) + sizeof(bool);
+static const size_t kMinComputerRecordSize = 3 * sizeof(int) + 12 * sizeof(size_t);
+
+static size_t employeeSize(const Employee& e) {
+    size_t size = sizeof(int) + sizeof(bool);
+    size += BinaryWriter::stringSize(e.institute);
+    size += BinaryWriter::stringSize(e.department);
+    size += BinaryWriter::stringSize(e.lastName);
+    size += BinaryWriter::stringSize(e.initials);
+    size += BinaryWriter::stringSize(e.position);
+    size += BinaryWriter::stringSize(e.phone);
+    size += BinaryWriter::stringSize(e.email);
+    size += BinaryWriter::stringSize(e.employmentDate);
+    size += BinaryWriter::stringSize(e.status);
+    if (e.computerId.has_value())
+        size += sizeof(int);
+    return size;
+}
+
+static size_t computerSize(const Computer& c) {
+    size_t size = 3 * sizeof(int);
+    size += BinaryWriter::stringSize(c.inventoryNumber);
+    size += BinaryWriter::stringSize(c.serialNumber);
+    size += BinaryWriter::stringSize(c.manufacturer);
+    size += BinaryWriter::stringSize(c.model);
+    size += BinaryWriter::stringSize(c.cpuModel);
+    size += BinaryWriter::stringSize(c.chipset);
+    size += BinaryWriter::stringSize(c.storageType);
+    size += BinaryWriter::stringSize(c.roomNumber);
+    size += BinaryWriter::stringSize(c.condition);
+    size += BinaryWriter::stringSize(c.commissioningDate);
+    size += BinaryWriter::stringSize(c.lastMaintenanceDate);
+    size += BinaryWriter::stringSize(c.warrantyExpirationDate);
+    return size;
+}
+
+static void writeEmployee(BinaryWriter& out, const Employee& e) {
+    out.writeInt(e.id);
+
+    out.writeString(e.institute);
+    out.writeString(e.department);
+    out.writeString(e.lastName);
+    out.writeString(e.initials);
+    out.writeString(e.position);
+    out.writeString(e.phone);
+    out.writeString(e.email);
+    out.writeString(e.employmentDate);
+    out.writeString(e.status);
+
+    out.writeBool(e.computerId.has_value());
+    if (e.computerId.has_value())
+        out.writeInt(e.computerId.value());
+}
 
-static void writeString(std::ostringstream& out, const std::string& str) {
-    size_t size = str.size();
-    out.write(reinterpret_cast<const char*>(&size), sizeof(size));
-    out.write(str.c_str(), size);
+static void writeComputer(BinaryWriter& out, const Computer& c) {
+    out.writeInt(c.id);
+
+    out.writeString(c.inventoryNumber);
+    out.writeString(c.serialNumber);
+    out.writeString(c.manufacturer);
+    out.writeString(c.model);
+    out.writeString(c.cpuModel);
+    out.writeString(c.chipset);
+
+    out.writeInt(c.ramSize);
+    out.writeString(c.storageType);
+    out.writeInt(c.storageSize);
+
+    out.writeString(c.roomNumber);
+    out.writeString(c.condition);
+    out.writeString(c.commissioningDate);
+    out.writeString(c.lastMaintenanceDate);
+    out.writeString(c.warrantyExpirationDate);
 }
 
-static std::string readString(std::istringstream& in) {
-    size_t size;
-    in.read(reinterpret_cast<char*>(&size), sizeof(size));
+static Employee readEmployee(BinaryReader& in) {
+    Employee e;
+
+    e.id = in.readInt();
 
-    std::string str(size, '\0');
-    in.read(&str[0], size);
+    e.institute = in.readStringView();
+    e.department = in.readStringView();
+    e.lastName = in.readString();
+    e.initials = in.readString();
+    e.position = in.readStringView();
+    e.phone = in.readString();
+    e.email = in.readString();
+    e.employmentDate = in.readString();
+    e.status = in.readStringView();
 
-    return str;
+    if (in.readBool())
+        e.computerId = in.readInt();
+
+    return e;
 }
 
-std::vector<unsigned char> Serializer::serialize(const Database& db) {
-    std::ostringstream out(std::ios::binary);
+static Computer readComputer(BinaryReader& in) {
+    Computer c;
 
-    const auto& employees = db.getEmployees();
-    size_t employeeCount = employees.size();
-    out.write(reinterpret_cast<const char*>(&employeeCount), sizeof(employeeCount));
+    c.id = in.readInt();
 
-    for (const auto& e : employees) {
-        out.write(reinterpret_cast<const char*>(&e.id), sizeof(e.id));
+    c.inventoryNumber = in.readString();
+    c.serialNumber = in.readString();
+    c.manufacturer = in.readStringView();
+    c.model = in.readString();
+    c.cpuModel = in.readString();
+    c.chipset = in.readStringView();
 
-        writeString(out, e.institute);
-        writeString(out, e.department);
-        writeString(out, e.lastName);
-        writeString(out, e.initials);
-        writeString(out, e.position);
-        writeString(out, e.phone);
-        writeString(out, e.email);
-        writeString(out, e.employmentDate);
-        writeString(out, e.status);
+    c.ramSize = in.readInt();
+    c.storageType = in.readStringView();
+    c.storageSize = in.readInt();
 
-        bool hasComputer = e.computerId.has_value();
-        out.write(reinterpret_cast<const char*>(&hasComputer), sizeof(hasComputer));
+    c.roomNumber = in.readStringView();
+    c.condition = in.readStringView();
+    c.commissioningDate = in.readString();
+    c.lastMaintenanceDate = in.readString();
+    c.warrantyExpirationDate = in.readString();
 
-        if (hasComputer) {
-            int compId = e.computerId.value();
-            out.write(reinterpret_cast<const char*>(&compId), sizeof(compId));
-        }
-    }
+    return c;
+}
 
-    const auto& computers = db.getComputers();
-    size_t computerCount = computers.size();
-    out.write(reinterpret_cast<const char*>(&computerCount), sizeof(computerCount));
-
-    for (const auto& c : computers) {
-        out.write(reinterpret_cast<const char*>(&c.id), sizeof(c.id));
-
-        writeString(out, c.inventoryNumber);
-        writeString(out, c.serialNumber);
-        writeString(out, c.manufacturer);
-        writeString(out, c.model);
-        writeString(out, c.cpuModel);
-        writeString(out, c.chipset);
-
-        out.write(reinterpret_cast<const char*>(&c.ramSize), sizeof(c.ramSize));
-        writeString(out, c.storageType);
-        out.write(reinterpret_cast<const char*>(&c.storageSize), sizeof(c.storageSize));
-
-        writeString(out, c.roomNumber);
-        writeString(out, c.condition);
-        writeString(out, c.commissioningDate);
-        writeString(out, c.lastMaintenanceDate);
-        writeString(out, c.warrantyExpirationDate);
-    }
+template <typename Record>
+static std::vector<Record> decodeRecords(const unsigned char* data,
+                                         const database_format::SectionEntry& section,
+                                         size_t minRecordSize,
+                                         Record (*readRecord)(BinaryReader&)) {
+    BinaryReader in(data + section.offset, static_cast<size_t>(section.length));
+
+    std::vector<Record> records;
+    records.reserve(static_cast<size_t>(
+        std::min<uint64_t>(section.recordCount, section.length / minRecordSize)));
+
+    for (uint64_t i = 0; i < section.recordCount; ++i)
+        records.push_back(readRecord(in));
 
-    std::string buffer = out.str();
-    return std::vector<unsigned char>(buffer.begin(), buffer.end());
+    if (in.remaining() != 0)
+        throw std::runtime_error("Данные базы повреждены: лишние данные в разделе " +
+                                 std::to_string(section.id));
+
+    return records;
 }
 
-Database Serializer::deserialize(const std::vector<unsigned char>& data) {
-    std::istringstream in(
-        std::string(data.begin(), data.end()),
-        std::ios::binary
-    );
+static Database deserializeLegacy(const unsigned char* data, size_t size) {
+    BinaryReader in(data, size);
 
-    Database db;
+    size_t employeeCount = in.readSize();
 
-    size_t employeeCount;
-    in.read(reinterpret_cast<char*>(&employeeCount), sizeof(employeeCount));
+    std::vector<Employee> employees;
+    employees.reserve(std::min(employeeCount, in.remaining() / kMinEmployeeRecordSize));
 
-    for (size_t i = 0; i < employeeCount; ++i) {
-        Employee e;
+    for (size_t i = 0; i < employeeCount; ++i)
+        employees.push_back(readEmployee(in));
 
-        in.read(reinterpret_cast<char*>(&e.id), sizeof(e.id));
+    size_t computerCount = in.readSize();
 
-        e.institute = readString(in);
-        e.department = readString(in);
-        e.lastName = readString(in);
-        e.initials = readString(in);
-        e.position = readString(in);
-        e.phone = readString(in);
-        e.email = readString(in);
-        e.employmentDate = readString(in);
-        e.status = readString(in);
+    std::vector<Computer> computers;
+    computers.reserve(std::min(computerCount, in.remaining() / kMinComputerRecordSize));
 
-        bool hasComputer;
-        in.read(reinterpret_cast<char*>(&hasComputer), sizeof(hasComputer));
+    for (size_t i = 0; i < computerCount; ++i)
+        computers.push_back(readComputer(in));
 
-        if (hasComputer) {
-            int compId;
-            in.read(reinterpret_cast<char*>(&compId), sizeof(compId));
-            e.computerId = compId;
-        }
+    Database db;
+    db.bulkLoad(std::move(employees), std::move(computers));
+    return db;
+}
 
-        db.addEmployeeWithId(e);
+struct ChunkEntry {
+    uint64_t offset;
+    uint64_t length;
+    uint64_t recordCount;
+};
+
+// Раскладка раздела на блоки по kRecordsPerChunk записей; возвращает длину раздела
+template <typename Record>
+static uint64_t layoutChunks(const RecordTable<Record>& records,
+                             size_t (*recordSize)(const Record&),
+                             std::vector<ChunkEntry>& chunks) {
+    uint64_t length = 0;
+    size_t i = 0;
+    for (const Record& record : records) {
+        if (i++ % database_format::kRecordsPerChunk == 0)
+            chunks.push_back({ length, 0, 0 });
+        uint64_t size = recordSize(record);
+        chunks.back().length += size;
+        chunks.back().recordCount += 1;
+        length += size;
     }
+    return length;
+}
 
-    size_t computerCount;
-    in.read(reinterpret_cast<char*>(&computerCount), sizeof(computerCount));
+static void writeSectionEntry(BinaryWriter& out,
+                              database_format::SectionId id,
+                              uint64_t offset,
+                              uint64_t length,
+                              uint64_t recordCount) {
+    out.writeUInt32(static_cast<uint32_t>(id));
+    out.writeUInt64(offset);
+    out.writeUInt64(length);
+    out.writeUInt64(recordCount);
+}
 
-    for (size_t i = 0; i < computerCount; ++i) {
-        Computer c;
+static void writeChunkTable(BinaryWriter& out, const std::vector<ChunkEntry>& chunks) {
+    for (const auto& chunk : chunks) {
+        out.writeUInt64(chunk.offset);
+        out.writeUInt64(chunk.length);
+        out.writeUInt64(chunk.recordCount);
+    }
+}
 
-        in.read(reinterpret_cast<char*>(&c.id), sizeof(c.id));
+struct DatabaseLayout {
+    std::vector<ChunkEntry> employeeChunks;
+    std::vector<ChunkEntry> computerChunks;
+    uint64_t employeesOffset;
+    uint64_t employeesLength;
+    uint64_t computersOffset;
+    uint64_t computersLength;
+    uint64_t employeeChunksOffset;
+    uint64_t computerChunksOffset;
+    uint64_t totalSize;
+};
+
+static const uint32_t kSectionCount = 4;
+
+// Размер промежуточного буфера при потоковой записи
+static const size_t kStreamBufferSize = 64 * 1024;
+
+static DatabaseLayout layoutDatabase(const DatabaseSnapshot& data) {
+    using namespace database_format;
+
+    DatabaseLayout layout;
+    layout.employeesLength = layoutChunks(data.employees, &employeeSize, layout.employeeChunks);
+    layout.computersLength = layoutChunks(data.computers, &computerSize, layout.computerChunks);
+
+    layout.employeesOffset = kFixedHeaderSize + kSectionCount * kSectionEntrySize;
+    layout.computersOffset = layout.employeesOffset + layout.employeesLength;
+    layout.employeeChunksOffset = layout.computersOffset + layout.computersLength;
+    layout.computerChunksOffset = layout.employeeChunksOffset +
+                                  layout.employeeChunks.size() * kChunkEntrySize;
+    layout.totalSize = layout.computerChunksOffset +
+                       layout.computerChunks.size() * kChunkEntrySize;
+    return layout;
+}
 
-        c.inventoryNumber = readString(in);
-        c.serialNumber = readString(in);
-        c.manufacturer = readString(in);
-        c.model = readString(in);
-        c.cpuModel = readString(in);
-        c.chipset = readString(in);
+static void writeDatabase(BinaryWriter& out, const DatabaseSnapshot& data, const DatabaseLayout& layout) {
+    using namespace database_format;
 
-        in.read(reinterpret_cast<char*>(&c.ramSize), sizeof(c.ramSize));
-        c.storageType = readString(in);
-        in.read(reinterpret_cast<char*>(&c.storageSize), sizeof(c.storageSize));
+    const auto& employees = data.employees;
+    const auto& computers = data.computers;
 
-        c.roomNumber = readString(in);
-        c.condition = readString(in);
-        c.commissioningDate = readString(in);
-        c.lastMaintenanceDate = readString(in);
-        c.warrantyExpirationDate = readString(in);
+    out.writeBytes(kMagic, sizeof(kMagic));
+    out.writeUInt32(kFormatVersion);
+    out.writeUInt32(kSchemaVersion);
+    out.writeUInt32(kSectionCount);
 
-        db.addComputerWithId(c);
+    writeSectionEntry(out, SectionId::Employees, layout.employeesOffset,
+                      layout.employeesLength, employees.size());
+    writeSectionEntry(out, SectionId::Computers, layout.computersOffset,
+                      layout.computersLength, computers.size());
+    writeSectionEntry(out, SectionId::EmployeeChunks, layout.employeeChunksOffset,
+                      layout.employeeChunks.size() * kChunkEntrySize, layout.employeeChunks.size());
+    writeSectionEntry(out, SectionId::ComputerChunks, layout.computerChunksOffset,
+                      layout.computerChunks.size() * kChunkEntrySize, layout.computerChunks.size());
+
+    for (const auto& e : employees)
+        writeEmployee(out, e);
+
+    for (const auto& c : computers)
+        writeComputer(out, c);
+
+    writeChunkTable(out, layout.employeeChunks);
+    writeChunkTable(out, layout.computerChunks);
+}
+
+void Serializer::serialize(const DatabaseSnapshot& data, const Output& output) {
+    DatabaseLayout layout = layoutDatabase(data);
+
+    std::vector<unsigned char> staging(kStreamBufferSize);
+    BinaryWriter out(staging.data(), staging.size(), output);
+    writeDatabase(out, data, layout);
+    out.flush();
+}
+
+std::vector<Employee> Serializer::decodeEmployees(const unsigned char* data,
+                                                  const database_format::SectionEntry& section) {
+    return decodeRecords(data, section, kMinEmployeeRecordSize, &readEmployee);
+}
+
+std::vector<Computer> Serializer::decodeComputers(const unsigned char* data,
+                                                  const database_format::SectionEntry& section) {
+    return decodeRecords(data, section, kMinComputerRecordSize, &readComputer);
+}
+
+Database Serializer::deserialize(const std::vector<unsigned char>& data) {
+    return deserialize(data.data(), data.size());
+}
+
+Database Serializer::deserialize(const unsigned char* data, size_t size) {
+    using namespace database_format;
+
+    if (!hasHeader(data, size)) {
+        Database db = deserializeLegacy(data, size);
+        db.validate();
+        return db;
     }
 
+    Header header = readHeader(data, size);
+
+    std::vector<Employee> employees;
+    std::vector<Computer> computers;
+
+    if (const SectionEntry* section = header.findSection(SectionId::Employees))
+        employees = decodeEmployees(data, *section);
+    if (const SectionEntry* section = header.findSection(SectionId::Computers))
+        computers = decodeComputers(data, *section);
+
+    Database db;
+    db.bulkLoad(std::move(employees), std::move(computers));
     db.validate();
     return db;
 }
+
+std::vector<unsigned char> Serializer::serializeChanges(const ChangeSet& changes) {
+    size_t total = 4 * sizeof(size_t) +
+        (changes.removedEmployeeIds.size() + changes.removedComputerIds.size()) * sizeof(int);
+    for (const auto& e : changes.employees)
+        total += employeeSize(e);
+    for (const auto& c : changes.computers)
+        total += computerSize(c);
+
+    std::vector<unsigned char> buffer(total);
+    BinaryWriter out(buffer.data(), buffer.size());
+
+    out.writeSize(changes.employees.size());
+    for (const auto& e : changes.employees)
+        writeEmployee(out, e);
+
+    out.writeSize(changes.removedEmployeeIds.size());
+    for (int id : changes.removedEmployeeIds)
+        out.writeInt(id);
+
+    out.writeSize(changes.computers.size());
+    for (const auto& c : changes.computers)
+        writeComputer(out, c);
+
+    out.writeSize(changes.removedComputerIds.size());
+    for (int id : changes.removedComputerIds)
+        out.writeInt(id);
+
+    return buffer;
+}
+
+ChangeSet Serializer::deserializeChanges(const unsigned char* data, size_t size) {
+    BinaryReader in(data, size);
+    ChangeSet changes;
+
+    size_t count = in.readSize();
+    changes.employees.reserve(std::min(count, in.remaining() / kMinEmployeeRecordSize));
+    for (size_t i = 0; i < count; ++i)
+        changes.employees.push_back(readEmployee(in));
+
+    count = in.readSize();
+    changes.removedEmployeeIds.reserve(std::min(count, in.remaining() / sizeof(int)));
+    for (size_t i = 0; i < count; ++i)
+        changes.removedEmployeeIds.push_back(in.readInt());
+
+    count = in.readSize();
+    changes.computers.reserve(std::min(count, in.remaining() / kMinComputerRecordSize));
+    for (size_t i = 0; i < count; ++i)
+        changes.computers.push_back(readComputer(in));
+
+    count = in.readSize();
+    changes.removedComputerIds.reserve(std::min(count, in.remaining() / sizeof(int)));
+    for (size_t i = 0; i < count; ++i)
+        changes.removedComputerIds.push_back(in.readInt());
+
+    if (in.remaining() != 0)
+        throw std::runtime_error("Данные журнала повреждены: лишние данные в записи");
+
+    return changes;
+}
@@ -1,9 +1,27 @@
 #pragma once
+#include <cstddef>
+#include <functional>
 #include <vector>
 #include "../core/Database.h"
+#include "DatabaseFormat.h"
 
 class Serializer {
 public:
-    static std::vector<unsigned char> serialize(const Database& db);
+    using Output = std::function<void(const unsigned char*, size_t)>;
+
+    // Потоковая запись снимка базы: данные отдаются в output кусками через
+    // небольшой буфер; безопасно вызывать из фонового потока
+    static void serialize(const DatabaseSnapshot& data, const Output& output);
     static Database deserialize(const std::vector<unsigned char>& data);
+    static Database deserialize(const unsigned char* data, size_t size);
+
+    // Декодирование отдельных разделов; section берется из database_format::readHeader
+    static std::vector<Employee> decodeEmployees(const unsigned char* data,
+                                                 const database_format::SectionEntry& section);
+    static std::vector<Computer> decodeComputers(const unsigned char* data,
+                                                 const database_format::SectionEntry& section);
+
+    // Набор изменений для журнала: записи в том же формате, что и в разделах
+    static std::vector<unsigned char> serializeChanges(const ChangeSet& changes);
+    static ChangeSet deserializeChanges(const unsigned char* data, size_t size);
 };
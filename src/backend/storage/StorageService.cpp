@@ -1,44 +1,214 @@
 #include "StorageService.h"
+#include "AtomicFile.h"
+#include "Compression.h"
+#include "DatabaseFormat.h"
+#include "Journal.h"
 #include "Serializer.h"
+#include "../crypto/ChunkedCipher.h"
 #include "../crypto/CryptoService.h"
+#include "../utils/ThreadPool.h"
 
 #include <fstream>
+#include <future>
 #include <vector>
 #include <stdexcept>
 
+template <typename Record>
+static std::vector<Record> joinChunks(std::vector<std::vector<Record>> parts) {
+    size_t total = 0;
+    for (const auto& part : parts)
+        total += part.size();
+
+    std::vector<Record> records;
+    records.reserve(total);
+    for (auto& part : parts)
+        records.insert(records.end(),
+                       std::make_move_iterator(part.begin()),
+                       std::make_move_iterator(part.end()));
+    return records;
+}
+
+// Разделы и их блоки декодируются параллельно в общем пуле и склеиваются
+// в исходном порядке записей
+static Database decodeDatabase(const unsigned char* data, size_t size) {
+    using namespace database_format;
+
+    if (!hasHeader(data, size))
+        return Serializer::deserialize(data, size);
+
+    Header header = readHeader(data, size);
+    std::vector<SectionEntry> employeeChunks =
+        readChunks(data, header, SectionId::Employees, SectionId::EmployeeChunks);
+    std::vector<SectionEntry> computerChunks =
+        readChunks(data, header, SectionId::Computers, SectionId::ComputerChunks);
+
+    ThreadPool& pool = ThreadPool::shared();
+
+    std::vector<std::future<std::vector<Employee>>> employeeParts;
+    employeeParts.reserve(employeeChunks.size());
+    for (const auto& chunk : employeeChunks)
+        employeeParts.push_back(pool.submit([data, chunk]() {
+            return Serializer::decodeEmployees(data, chunk);
+        }));
+
+    std::vector<std::future<std::vector<Computer>>> computerParts;
+    computerParts.reserve(computerChunks.size());
+    for (const auto& chunk : computerChunks)
+        computerParts.push_back(pool.submit([data, chunk]() {
+            return Serializer::decodeComputers(data, chunk);
+        }));
+
+    // Обе группы задач должны закончить работу с data до возможного исключения
+    for (auto& part : computerParts)
+        part.wait();
+
+    std::vector<Employee> employees = joinChunks(waitAll(employeeParts));
+    std::vector<Computer> computers = joinChunks(waitAll(computerParts));
+
+    Database db;
+    db.bulkLoad(std::move(employees), std::move(computers));
+    db.validate();
+    return db;
+}
+
+SnapshotInfo StorageService::saveDatabase(const Database& db,
+                                          const std::string& filePath,
+                                          const CryptoKey& key)
+{
+    db.validate();
+    return saveSnapshot(db.snapshot(), filePath, key);
+}
+
+SnapshotInfo StorageService::saveSnapshot(DatabaseSnapshot records,
+                                          const std::string& filePath,
+                                          const CryptoKey& key) const
+{
+    // Блоки пишутся во временный файл по мере шифрования; прежний файл
+    // заменяется только после успешной записи всех данных
+    AtomicFileWriter out(filePath);
+
+    uint64_t fileSize = 0;
+    ChunkedEncryptor encryptor(
+        key,
+        [&out, &fileSize](const unsigned char* data, size_t size) {
+            out.write(data, size);
+            fileSize += size;
+        });
+
+    auto encrypt = [&encryptor](const unsigned char* data, size_t size) {
+        encryptor.write(data, size);
+    };
+
+    if (codec == compression::Codec::None) {
+        Serializer::serialize(records, encrypt);
+    } else {
+        CompressingWriter compressor(codec, encrypt);
+        Serializer::serialize(records, [&compressor](const unsigned char* data, size_t size) {
+            compressor.write(data, size);
+        });
+        compressor.finish();
+    }
+
+    // Пока таблицы разделены со снимком, изменение базы копирует их целиком
+    records = DatabaseSnapshot();
+
+    encryptor.finish();
+    out.commit();
+
+    // Изменения из старого журнала уже вошли в новый файл базы
+    journal::remove(filePath);
+
+    SnapshotInfo snapshot;
+    snapshot.path = filePath;
+    snapshot.baseId = encryptor.getNoncePrefix();
+    snapshot.baseSize = fileSize;
+    return snapshot;
+}
+
 void StorageService::saveDatabase(const Database& db,
                                   const std::string& filePath,
                                   const std::string& password)
 {
-    db.validate();
-
-    std::vector<unsigned char> rawData = Serializer::serialize(db);
+    saveDatabase(db, filePath, CryptoService::deriveKey(password, CryptoService::makeKdfParams()));
+}
 
-    std::vector<unsigned char> encrypted =
-        CryptoService::encrypt(rawData, password);
+void StorageService::appendJournal(const ChangeSet& changes,
+                                   const CryptoKey& key,
+                                   SnapshotInfo& snapshot) const
+{
+    journal::append(changes, key, snapshot);
+}
 
-    std::ofstream out(filePath, std::ios::binary);
-    if (!out.is_open())
-        throw std::runtime_error("Cannot open file for writing");
+// Расшифрованные данные файла лежат в buffer начиная с offset. Сжатые
+// распаковываются в новый буфер, а buffer освобождается до декодирования
+// записей, чтобы обе копии не держались в памяти вместе с базой
+static Database decodePayload(std::vector<unsigned char>& buffer, size_t offset, size_t size) {
+    const unsigned char* data = buffer.data() + offset;
+    if (!compression::hasHeader(data, size))
+        return decodeDatabase(data, size);
 
-    out.write(reinterpret_cast<const char*>(encrypted.data()),
-              encrypted.size());
+    std::vector<unsigned char> raw = compression::decompress(data, size);
+    buffer = std::vector<unsigned char>();
+    return decodeDatabase(raw.data(), raw.size());
 }
 
 Database StorageService::loadDatabase(const std::string& filePath,
                                       const std::string& password)
 {
-    std::ifstream in(filePath, std::ios::binary);
+    CryptoKey key;
+    SnapshotInfo snapshot;
+    return loadDatabase(filePath, password, key, snapshot);
+}
+
+Database StorageService::loadDatabase(const std::string& filePath,
+                                      const std::string& password,
+                                      CryptoKey& key,
+                                      SnapshotInfo& snapshot)
+{
+    std::ifstream in(filePath, std::ios::binary | std::ios::ate);
     if (!in.is_open())
         throw std::runtime_error("Cannot open file for reading");
 
-    std::vector<unsigned char> encrypted(
-        (std::istreambuf_iterator<char>(in)),
-        std::istreambuf_iterator<char>()
-    );
+    // Файл читается целиком в один буфер и расшифровывается в нем же,
+    // так что на пике в памяти одна копия файла
+    std::vector<unsigned char> buffer(static_cast<size_t>(in.tellg()));
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+    if (static_cast<size_t>(in.gcount()) != buffer.size())
+        throw std::runtime_error("Failed to read database file");
+
+    SnapshotInfo loaded;
+    loaded.path = filePath;
+    loaded.baseSize = buffer.size();
+
+    if (!chunked_cipher::hasHeader(buffer.data(), buffer.size())) {
+        // Файл старого формата: IV + AES-256-CBC, журнал для него не ведется
+        size_t decryptedSize = CryptoService::decrypt(buffer.data(), buffer.size(), password);
+
+        Database db = decodePayload(buffer, 0, decryptedSize);
+        key = CryptoService::deriveKey(password, KdfParams());
+        snapshot = std::move(loaded);
+        return db;
+    }
+
+    ChunkedDecryptor decryptor(buffer.data(), buffer.size());
+    CryptoKey fileKey = CryptoService::deriveKey(password, decryptor.getKdfParams());
+    decryptor.unlock(fileKey.key);
+    loaded.baseId = decryptor.getNoncePrefix();
+
+    size_t payloadSize = decryptor.decryptInPlace(buffer.data() + decryptor.getHeaderSize(),
+                                                  buffer.size() - decryptor.getHeaderSize());
+
+    Database db = decodePayload(buffer, decryptor.getHeaderSize(), payloadSize);
+    buffer = std::vector<unsigned char>();
 
-    std::vector<unsigned char> decrypted =
-        CryptoService::decrypt(encrypted, password);
+    std::vector<ChangeSet> changes = journal::read(password, fileKey, loaded);
+    if (!changes.empty()) {
+        db.applyChanges(changes);
+        db.validateChanges();
+    }
 
-    return Serializer::deserialize(decrypted);
+    key = std::move(fileKey);
+    snapshot = std::move(loaded);
+    return db;
 }
@@ -1,13 +1,50 @@
 #pragma once
 #include <string>
+#include "Compression.h"
+#include "Journal.h"
 #include "../core/Database.h"
+#include "../crypto/CryptoService.h"
 
 class StorageService {
+private:
+    compression::Codec codec = compression::Codec::Lz4;
+
 public:
+    // Сжатие перед шифрованием при сохранении; при загрузке алгоритм
+    // определяется по заголовку данных
+    void setCompression(compression::Codec codec) { this->codec = codec; }
+    compression::Codec getCompression() const { return codec; }
+
+    // Шифрует уже выработанным ключом; параметры KDF пишутся в заголовок.
+    // Полная запись файла: журнал изменений рядом с ним удаляется.
+    SnapshotInfo saveDatabase(const Database& db,
+                              const std::string& filePath,
+                              const CryptoKey& key);
+
+    // Запись снимка базы без проверки (см. Database::validateChanges);
+    // не меняет состояние сервиса, поэтому выполняется в фоновом потоке.
+    // Снимок отпускается сразу после сериализации, до синхронизации файла
+    SnapshotInfo saveSnapshot(DatabaseSnapshot records,
+                              const std::string& filePath,
+                              const CryptoKey& key) const;
+
+    // Вырабатывает ключ с новой солью при каждом вызове
     void saveDatabase(const Database& db,
                       const std::string& filePath,
                       const std::string& password);
 
+    // Дописывает изменения в журнал файла snapshot вместо полной записи
+    void appendJournal(const ChangeSet& changes,
+                       const CryptoKey& key,
+                       SnapshotInfo& snapshot) const;
+
+    // Загружает файл базы и применяет к нему журнал изменений. В key и
+    // snapshot возвращаются ключ файла и сведения для последующих сохранений.
+    Database loadDatabase(const std::string& filePath,
+                          const std::string& password,
+                          CryptoKey& key,
+                          SnapshotInfo& snapshot);
+
     Database loadDatabase(const std::string& filePath,
                           const std::string& password);
 };
@@ -0,0 +1,138 @@
+#include "ColumnScan.h"
+
+#include <algorithm>
+#include <bitset>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define COLUMN_SCAN_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// Ядрам AVX2 нужен атрибут target в GCC/Clang; MSVC собирает их без флагов
+#if defined(COLUMN_SCAN_X86) && !defined(_MSC_VER)
+#define COLUMN_SCAN_AVX2 __attribute__((target("avx2")))
+#else
+#define COLUMN_SCAN_AVX2
+#endif
+
+namespace column_scan {
+
+Selection::Selection(size_t rows, bool selected)
+    : words((rows + 63) / 64, selected ? ~uint64_t(0) : 0),
+      rows(rows)
+{
+    if (selected && rows % 64)
+        words.back() = (uint64_t(1) << (rows % 64)) - 1;
+}
+
+size_t Selection::count() const {
+    size_t total = 0;
+    for (uint64_t word : words)
+        total += std::bitset<64>(word).count();
+    return total;
+}
+
+namespace {
+    // Условие low <= v <= high сводится к одному беззнаковому сравнению:
+    // (v - low) <= (high - low) по модулю 2^32
+    using WordKernel = uint64_t (*)(const int32_t* values, uint32_t low, uint32_t span);
+
+    uint64_t scalarMask(const int32_t* values, size_t count, uint32_t low, uint32_t span) {
+        uint64_t mask = 0;
+        for (size_t i = 0; i < count; ++i)
+            mask |= uint64_t(static_cast<uint32_t>(values[i]) - low <= span) << i;
+        return mask;
+    }
+
+#ifndef COLUMN_SCAN_X86
+    uint64_t scalarWord(const int32_t* values, uint32_t low, uint32_t span) {
+        return scalarMask(values, 64, low, span);
+    }
+#else
+    // В SSE2/AVX2 нет беззнакового сравнения: обе стороны сдвигаются
+    // на 2^31 (инверсия знакового бита) и сравниваются как знаковые
+    uint64_t sse2Word(const int32_t* values, uint32_t low, uint32_t span) {
+        const __m128i sign = _mm_set1_epi32(INT32_MIN);
+        const __m128i lowV = _mm_set1_epi32(static_cast<int32_t>(low));
+        const __m128i limit = _mm_xor_si128(_mm_set1_epi32(static_cast<int32_t>(span)), sign);
+
+        uint64_t outside = 0;
+        for (int i = 0; i < 64; i += 4) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+            __m128i shifted = _mm_xor_si128(_mm_sub_epi32(v, lowV), sign);
+            __m128i greater = _mm_cmpgt_epi32(shifted, limit);
+            outside |= uint64_t(_mm_movemask_ps(_mm_castsi128_ps(greater))) << i;
+        }
+        return ~outside;
+    }
+
+    COLUMN_SCAN_AVX2
+    uint64_t avx2Word(const int32_t* values, uint32_t low, uint32_t span) {
+        const __m256i sign = _mm256_set1_epi32(INT32_MIN);
+        const __m256i lowV = _mm256_set1_epi32(static_cast<int32_t>(low));
+        const __m256i limit = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int32_t>(span)), sign);
+
+        uint64_t outside = 0;
+        for (int i = 0; i < 64; i += 8) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+            __m256i shifted = _mm256_xor_si256(_mm256_sub_epi32(v, lowV), sign);
+            __m256i greater = _mm256_cmpgt_epi32(shifted, limit);
+            outside |= uint64_t(_mm256_movemask_ps(_mm256_castsi256_ps(greater))) << i;
+        }
+        return ~outside;
+    }
+
+    bool hasAvx2() {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+        __cpuid(info, 1);
+        bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+        __cpuidex(info, 7, 0);
+        return osSavesYmm && (info[1] & (1 << 5));
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif
+
+    WordKernel selectKernel() {
+#ifdef COLUMN_SCAN_X86
+        return hasAvx2() ? avx2Word : sse2Word;
+#else
+        return scalarWord;
+#endif
+    }
+}
+
+void keepInRange(const int32_t* values, size_t count,
+                 int32_t low, int32_t high, Selection& selection) {
+    count = std::min(count, selection.size());
+    uint64_t* words = selection.data();
+
+    if (high < low) {
+        std::fill(words, words + (count + 63) / 64, 0);
+        return;
+    }
+
+    static const WordKernel kernel = selectKernel();
+    uint32_t lowBits = static_cast<uint32_t>(low);
+    uint32_t span = static_cast<uint32_t>(high) - lowBits;
+
+    size_t fullWords = count / 64;
+    for (size_t w = 0; w < fullWords; ++w) {
+        // Слова, где уже ничего не выбрано, не просматриваются
+        if (words[w])
+            words[w] &= kernel(values + w * 64, lowBits, span);
+    }
+
+    if (count % 64)
+        words[fullWords] &= scalarMask(values + fullWords * 64, count % 64, lowBits, span);
+}
+
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace column_scan {
+
+// Набор выбранных строк столбца: бит i - строка i. Фильтры по столбцам
+// только сбрасывают биты, поэтому несколько условий применяются подряд
+// к одной выборке без промежуточных списков строк.
+class Selection {
+public:
+    // По умолчанию выбраны все строки
+    explicit Selection(size_t rows = 0, bool selected = true);
+
+    size_t size() const { return rows; }
+    bool test(size_t row) const { return (words[row / 64] >> (row % 64)) & 1; }
+    size_t count() const;
+    void set(size_t row) { words[row / 64] |= uint64_t(1) << (row % 64); }
+
+    uint64_t* data() { return words.data(); }
+    const uint64_t* data() const { return words.data(); }
+
+    // Вызывает f(row) для выбранных строк по возрастанию номера
+    template <typename F>
+    void forEach(F f) const {
+        for (size_t w = 0; w < words.size(); ++w) {
+            uint64_t bits = words[w];
+            while (bits) {
+                f(w * 64 + lowestBit(bits));
+                bits &= bits - 1;
+            }
+        }
+    }
+
+private:
+    std::vector<uint64_t> words;
+    size_t rows = 0;
+
+    static unsigned lowestBit(uint64_t bits) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, bits);
+        return index;
+#else
+        return __builtin_ctzll(bits);
+#endif
+    }
+};
+
+// Оставляет в выборке строки, у которых low <= values[i] <= high.
+// Сравнение идет по 8 (AVX2) или 4 (SSE2) значения за раз; вариант
+// выбирается по процессору при первом вызове
+void keepInRange(const int32_t* values, size_t count,
+                 int32_t low, int32_t high, Selection& selection);
+
+}
@@ -1,7 +1,7 @@
 #include "DateUtils.h"
 
-#include <cctype>
 #include <ctime>
+#include <mutex>
 
 namespace {
     struct DateParts {
@@ -10,22 +10,6 @@ namespace {
         int day;
     };
 
-    bool parseInt(const std::string& s, int& out) {
-        if (s.empty())
-            return false;
-        for (char ch : s) {
-            if (!std::isdigit(static_cast<unsigned char>(ch)))
-                return false;
-        }
-        try {
-            out = std::stoi(s);
-            return true;
-        }
-        catch (...) {
-            return false;
-        }
-    }
-
     bool isLeapYear(int year) {
         return (year % 400 == 0) || (year % 4 == 0 && year % 100 != 0);
     }
@@ -37,6 +21,33 @@ namespace {
         return days[month - 1];
     }
 
+    // Разбор строки фиксированной ширины гггг-мм-дд или дд.мм.гггг (дд/мм/гггг).
+    // Все десять символов обрабатываются одинаково и без ранних выходов:
+    // ошибки копятся в маске, поля выбираются по формату без ветвлений,
+    // поэтому цикл по символам компилятор может векторизовать.
+    bool decodeFixedDate(const char* text, DateParts& out) {
+        bool iso = (text[4] == '-') & (text[7] == '-');
+        bool dotted = ((text[2] == '.') | (text[2] == '/')) & (text[5] == text[2]);
+
+        unsigned digits[10];
+        unsigned notDigit = 0;
+        for (int i = 0; i < 10; ++i) {
+            digits[i] = static_cast<unsigned char>(text[i]) - unsigned('0');
+            // Разделители стоят на позициях 4, 7 (iso) или 2, 5 (dotted)
+            bool separator = iso ? (i == 4 || i == 7) : (i == 2 || i == 5);
+            notDigit |= static_cast<unsigned>(digits[i] > 9 && !separator);
+        }
+
+        const unsigned* y = iso ? digits : digits + 6;
+        const unsigned* m = digits + (iso ? 5 : 3);
+        const unsigned* d = iso ? digits + 8 : digits;
+
+        out.year = static_cast<int>(y[0] * 1000 + y[1] * 100 + y[2] * 10 + y[3]);
+        out.month = static_cast<int>(m[0] * 10 + m[1]);
+        out.day = static_cast<int>(d[0] * 10 + d[1]);
+        return (iso | dotted) & (notDigit == 0);
+    }
+
     bool isValidDate(const DateParts& d) {
         if (d.year < 1 || d.month < 1 || d.month > 12)
             return false;
@@ -46,68 +57,174 @@ namespace {
     }
 
     bool parseDate(const std::string& value, DateParts& out) {
-        if (value.size() == 10 && value[4] == '-' && value[7] == '-') {
-            int y, m, d;
-            if (!parseInt(value.substr(0, 4), y) ||
-                !parseInt(value.substr(5, 2), m) ||
-                !parseInt(value.substr(8, 2), d))
-                return false;
-
-            out = { y, m, d };
-            return true;
-        }
+        return value.size() == 10 && decodeFixedDate(value.data(), out);
+    }
+
+    // Число дней от 1 марта года 0 (алгоритм days_from_civil), сдвинутое
+    // на единицу, чтобы любая дата с годом >= 1 была больше kNoDate
+    date_utils::DayNumber dayNumberOf(const DateParts& d) {
+        int year = d.year - (d.month <= 2 ? 1 : 0);
+        int era = year / 400;
+        int yearOfEra = year - era * 400;
+        int dayOfYear = (153 * (d.month > 2 ? d.month - 3 : d.month + 9) + 2) / 5 + d.day - 1;
+        int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + dayOfEra + 1;
+    }
+}
+
+namespace date_utils {
+
+DayNumber toDayNumber(const std::string& value) {
+    if (value.empty())
+        return kNoDate;
+
+    DateParts parsed{};
+    if (!parseDate(value, parsed) || !isValidDate(parsed))
+        return kInvalidDate;
+
+    return dayNumberOf(parsed);
+}
 
-        if (value.size() == 10 &&
-            (value[2] == '.' || value[2] == '/') &&
-            value[5] == value[2]) {
-            int d, m, y;
-            if (!parseInt(value.substr(0, 2), d) ||
-                !parseInt(value.substr(3, 2), m) ||
-                !parseInt(value.substr(6, 4), y))
-                return false;
-
-            out = { y, m, d };
-            return true;
+// Номер первого дня и длина каждого месяца для годов
+// [kTableFirstYear, kTableFirstYear + kTableYears): пакетный разбор берет
+// номер дня из таблицы вместо делений days_from_civil и проверки високосности
+static const int kTableFirstYear = 1900;
+static const int kTableYears = 256;
+
+struct MonthTable {
+    DayNumber firstDay[kTableYears * 12];
+    unsigned char length[kTableYears * 12];
+};
+
+static const MonthTable& monthTable() {
+    static const MonthTable table = []() {
+        MonthTable built{};
+        for (int year = 0; year < kTableYears; ++year) {
+            for (int month = 1; month <= 12; ++month) {
+                int slot = year * 12 + month - 1;
+                built.firstDay[slot] = dayNumberOf({ kTableFirstYear + year, month, 1 });
+                built.length[slot] = static_cast<unsigned char>(daysInMonth(kTableFirstYear + year, month));
+            }
         }
+        return built;
+    }();
+    return table;
+}
 
-        return false;
-    }
+static unsigned digitAt(const unsigned char* text, int position) {
+    return text[position] - unsigned('0');
+}
 
-    DateParts todayDate() {
-        std::time_t t = std::time(nullptr);
-        std::tm local{};
-        localtime_s(&local, &t);
-        return { local.tm_year + 1900, local.tm_mon + 1, local.tm_mday };
+// Разбор строки ровно из 10 символов. Позиции полей выбираются по формату,
+// проверяются только восемь позиций цифр
+static DayNumber decodeDateText(const unsigned char* text, const MonthTable& table) {
+    bool iso = (text[4] == '-') & (text[7] == '-');
+    bool dotted = ((text[2] == '.') | (text[2] == '/')) & (text[5] == text[2]);
+
+    int y = iso ? 0 : 6;
+    int m = iso ? 5 : 3;
+    int d = iso ? 8 : 0;
+
+    unsigned notDigit = (digitAt(text, y) > 9) | (digitAt(text, y + 1) > 9) |
+                        (digitAt(text, y + 2) > 9) | (digitAt(text, y + 3) > 9) |
+                        (digitAt(text, m) > 9) | (digitAt(text, m + 1) > 9) |
+                        (digitAt(text, d) > 9) | (digitAt(text, d + 1) > 9);
+    if (!(iso | dotted) | notDigit)
+        return kInvalidDate;
+
+    DateParts parts;
+    parts.year = static_cast<int>(digitAt(text, y) * 1000 + digitAt(text, y + 1) * 100 +
+                                  digitAt(text, y + 2) * 10 + digitAt(text, y + 3));
+    parts.month = static_cast<int>(digitAt(text, m) * 10 + digitAt(text, m + 1));
+    parts.day = static_cast<int>(digitAt(text, d) * 10 + digitAt(text, d + 1));
+
+    unsigned year = static_cast<unsigned>(parts.year - kTableFirstYear);
+    unsigned month = static_cast<unsigned>(parts.month - 1);
+    if ((year < unsigned(kTableYears)) & (month < 12u)) {
+        unsigned slot = year * 12 + month;
+        bool dayOk = (parts.day >= 1) & (parts.day <= table.length[slot]);
+        return dayOk ? table.firstDay[slot] + parts.day - 1 : kInvalidDate;
     }
 
-    bool isFutureDate(const DateParts& d) {
-        DateParts today = todayDate();
-        if (d.year != today.year)
-            return d.year > today.year;
-        if (d.month != today.month)
-            return d.month > today.month;
-        return d.day > today.day;
+    return isValidDate(parts) ? dayNumberOf(parts) : kInvalidDate;
+}
+
+void decodeDateColumn(const char* const* texts,
+                      const size_t* lengths,
+                      size_t count,
+                      DayNumber* days,
+                      DayNumber today,
+                      bool allowFuture,
+                      DateStatus* statuses) {
+    const MonthTable& table = monthTable();
+
+    for (size_t i = 0; i < count; ++i) {
+        if (lengths[i] == 10)
+            days[i] = decodeDateText(reinterpret_cast<const unsigned char*>(texts[i]), table);
+        else
+            days[i] = lengths[i] == 0 ? kNoDate : kInvalidDate;
     }
+
+    if (statuses)
+        for (size_t i = 0; i < count; ++i)
+            statuses[i] = checkDay(days[i], today, allowFuture);
 }
 
-namespace date_utils {
+// Местное время запрашивается не чаще раза в сутки: номер дня хранится вместе
+// с моментом ближайшей местной полуночи
+DayNumber today() {
+    static std::mutex mutex;
+    static std::time_t validUntil = 0;
+    static DayNumber cached = kNoDate;
+
+    std::time_t now = std::time(nullptr);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (now < validUntil)
+        return cached;
+
+    std::tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &now);
+#else
+    localtime_r(&now, &local);
+#endif
+    cached = dayNumberOf({ local.tm_year + 1900, local.tm_mon + 1, local.tm_mday });
+    validUntil = now + (24 * 60 * 60 - (local.tm_hour * 60 * 60 + local.tm_min * 60 + local.tm_sec));
+    return cached;
+}
+
+DateStatus checkDay(DayNumber day, DayNumber today, bool allowFuture) {
+    if (day == kNoDate)
+        return DateStatus::Ok;
+
+    if (day == kInvalidDate)
+        return DateStatus::Invalid;
+
+    if (!allowFuture && day > today)
+        return DateStatus::Future;
+
+    return DateStatus::Ok;
+}
+
+DateStatus checkDate(const std::string& value, bool allowFuture) {
+    return checkDay(toDayNumber(value), today(), allowFuture);
+}
+
+std::string describeDateError(DateStatus status,
+                              const std::string& fieldLabel,
+                              const std::string& value) {
+    if (status == DateStatus::Future)
+        return "Дата в будущем " + fieldLabel + " (значение: " + value + ")";
+    return "Некорректная дата " + fieldLabel + " (значение: " + value + ")";
+}
 
 void validateDateField(const std::string& value,
                        const std::string& fieldLabel,
                        std::vector<std::string>& errors,
                        bool allowFuture) {
-    if (value.empty())
-        return;
-
-    DateParts parsed{};
-    if (!parseDate(value, parsed) || !isValidDate(parsed)) {
-        errors.push_back("Некорректная дата " + fieldLabel + " (значение: " + value + ")");
-        return;
-    }
-
-    if (!allowFuture && isFutureDate(parsed)) {
-        errors.push_back("Дата в будущем " + fieldLabel + " (значение: " + value + ")");
-    }
+    DateStatus status = checkDate(value, allowFuture);
+    if (status != DateStatus::Ok)
+        errors.push_back(describeDateError(status, fieldLabel, value));
 }
 
 }
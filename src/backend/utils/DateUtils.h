@@ -1,10 +1,108 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 
 namespace date_utils {
 
+// Дата, упакованная в номер дня: растет вместе с датой, поэтому даты
+// сравниваются и сортируются как целые числа, а сдвиг на N дней - сложение
+using DayNumber = int32_t;
+
+const DayNumber kNoDate = 0;        // пустая строка
+const DayNumber kInvalidDate = -1;  // строку не удалось разобрать
+
+enum class DateStatus {
+    Ok,
+    Invalid,
+    Future
+};
+
+// Разбор дд.мм.гггг, дд/мм/гггг или гггг-мм-дд в номер дня
+DayNumber toDayNumber(const std::string& value);
+
+// Разбор и проверка count дат одним проходом: строка texts[i] длиной
+// lengths[i] дает days[i] (как toDayNumber), а при statuses != nullptr еще
+// и statuses[i] (как checkDay относительно today). Для годов 1900-2155
+// номер дня берется из таблицы месяцев, без делений на каждую строку.
+void decodeDateColumn(const char* const* texts,
+                      const size_t* lengths,
+                      size_t count,
+                      DayNumber* days,
+                      DayNumber today,
+                      bool allowFuture,
+                      DateStatus* statuses);
+
+// Поле даты записей разбирается пачками по kDateBatch: адреса строк
+// собираются в массив, decodeDateColumn пишет номера дней, они
+// раскладываются обратно по записям
+const size_t kDateBatch = 256;
+
+template <typename Record>
+void decodeDateRecords(std::vector<Record>& records,
+                       const std::string Record::* text,
+                       DayNumber Record::* day,
+                       DayNumber today,
+                       bool allowFuture,
+                       DateStatus* statuses) {
+    const char* texts[kDateBatch];
+    size_t lengths[kDateBatch];
+    DayNumber days[kDateBatch];
+
+    for (size_t begin = 0; begin < records.size(); begin += kDateBatch) {
+        size_t count = std::min(kDateBatch, records.size() - begin);
+        for (size_t i = 0; i < count; ++i) {
+            const std::string& value = records[begin + i].*text;
+            texts[i] = value.data();
+            lengths[i] = value.size();
+        }
+        decodeDateColumn(texts, lengths, count, days, today, allowFuture,
+                         statuses ? statuses + begin : nullptr);
+        for (size_t i = 0; i < count; ++i)
+            records[begin + i].*day = days[i];
+    }
+}
+
+// Разбор одного поля даты у всех записей столбца (при загрузке базы)
+template <typename Record>
+void parseDateColumn(std::vector<Record>& records,
+                     const std::string Record::* text,
+                     DayNumber Record::* day) {
+    decodeDateRecords(records, text, day, kNoDate, true, nullptr);
+}
+
+// То же с проверкой: статус даты каждой записи в порядке records
+template <typename Record>
+std::vector<DateStatus> parseDateColumn(std::vector<Record>& records,
+                                        const std::string Record::* text,
+                                        DayNumber Record::* day,
+                                        DayNumber today,
+                                        bool allowFuture = false) {
+    std::vector<DateStatus> statuses(records.size());
+    decodeDateRecords(records, text, day, today, allowFuture, statuses.data());
+    return statuses;
+}
+
+// Номер текущего дня по местному времени; кэшируется до местной полуночи
+DayNumber today();
+
+inline bool isValidDay(DayNumber day) {
+    return day > kNoDate;
+}
+
+// Проверка уже разобранной даты
+DateStatus checkDay(DayNumber day, DayNumber today, bool allowFuture = false);
+
+// Проверка даты без формирования сообщения об ошибке; пустая дата допустима
+DateStatus checkDate(const std::string& value, bool allowFuture = false);
+
+std::string describeDateError(DateStatus status,
+                              const std::string& fieldLabel,
+                              const std::string& value);
+
 void validateDateField(const std::string& value,
                        const std::string& fieldLabel,
                        std::vector<std::string>& errors,
@@ -0,0 +1,93 @@
+#include "InternedString.h"
+
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace {
+    using Index = std::unordered_map<std::string_view, const InternedString::Entry*>;
+
+    // Значения лежат в deque и не перемещаются, поэтому указатели на них
+    // и ключи-представления индекса остаются действительными
+    struct Dictionary {
+        std::shared_mutex mutex;
+        std::deque<InternedString::Entry> entries;
+        Index index;
+    };
+
+    // Предел локального кэша потока: при переполнении кэш сбрасывается
+    const size_t kThreadCacheLimit = 4096;
+
+    Dictionary& dictionary() {
+        static Dictionary instance;
+        return instance;
+    }
+
+    // Записи словаря неизменяемы, поэтому уже найденные значения поток
+    // берет из своего кэша без блокировок. Общий индекс читается под
+    // разделяемой блокировкой (параллельное декодирование разделов не
+    // упирается в один мьютекс), исключительная - только для нового значения
+    const InternedString::Entry* intern(std::string_view value) {
+        if (value.empty())
+            return nullptr;
+
+        thread_local Index cache;
+        auto cached = cache.find(value);
+        if (cached != cache.end())
+            return cached->second;
+
+        Dictionary& dict = dictionary();
+        const InternedString::Entry* entry = nullptr;
+        {
+            std::shared_lock<std::shared_mutex> lock(dict.mutex);
+            auto it = dict.index.find(value);
+            if (it != dict.index.end())
+                entry = it->second;
+        }
+
+        if (!entry) {
+            std::unique_lock<std::shared_mutex> lock(dict.mutex);
+            auto it = dict.index.find(value);
+            if (it != dict.index.end()) {
+                entry = it->second;
+            } else {
+                uint32_t code = static_cast<uint32_t>(dict.entries.size() + 1);
+                dict.entries.push_back({ std::string(value), code });
+                entry = &dict.entries.back();
+                dict.index.emplace(entry->value, entry);
+            }
+        }
+
+        if (cache.size() >= kThreadCacheLimit)
+            cache.clear();
+        cache.emplace(entry->value, entry);
+        return entry;
+    }
+}
+
+InternedString::InternedString(const std::string& value)
+    : entry(intern(value))
+{
+}
+
+InternedString::InternedString(std::string_view value)
+    : entry(intern(value))
+{
+}
+
+InternedString::InternedString(const char* value)
+    : entry(intern(value))
+{
+}
+
+const std::string& InternedString::str() const {
+    static const std::string empty;
+    return entry ? entry->value : empty;
+}
+
+size_t InternedString::dictionarySize() {
+    Dictionary& dict = dictionary();
+    std::shared_lock<std::shared_mutex> lock(dict.mutex);
+    return dict.entries.size();
+}
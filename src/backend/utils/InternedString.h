@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+// Строка из общего словаря редко различающихся значений (институт, статус,
+// производитель и т.п.). Каждое значение хранится в словаре один раз,
+// запись держит только указатель на него, поэтому сравнение на равенство
+// и хеширование (фильтры, группировка) не сравнивают символы.
+// Словарь общий для всех баз и только растет: записи остаются
+// самостоятельными при копировании из базы в UI, журнал и снимки.
+// Повторные значения находятся в кэше потока без блокировок.
+class InternedString {
+public:
+    struct Entry {
+        std::string value;
+        uint32_t code;
+    };
+
+    InternedString() = default;
+    InternedString(const std::string& value);
+    InternedString(std::string_view value);
+    InternedString(const char* value);
+
+    const std::string& str() const;
+    operator const std::string&() const { return str(); }
+    std::string_view view() const { return str(); }
+
+    bool empty() const { return entry == nullptr; }
+    size_t size() const { return str().size(); }
+
+    // Номер значения в словаре; 0 - пустая строка
+    uint32_t code() const { return entry ? entry->code : 0; }
+
+    // Число различных непустых значений в словаре
+    static size_t dictionarySize();
+
+    friend bool operator==(const InternedString& a, const InternedString& b) { return a.entry == b.entry; }
+    friend bool operator!=(const InternedString& a, const InternedString& b) { return a.entry != b.entry; }
+    friend bool operator==(const InternedString& a, const std::string& b) { return a.str() == b; }
+    friend bool operator!=(const InternedString& a, const std::string& b) { return a.str() != b; }
+    friend bool operator==(const InternedString& a, const char* b) { return a.str() == b; }
+    friend bool operator!=(const InternedString& a, const char* b) { return a.str() != b; }
+
+private:
+    const Entry* entry = nullptr;
+};
+
+namespace std {
+template <>
+struct hash<InternedString> {
+    size_t operator()(const InternedString& value) const {
+        return std::hash<uint32_t>()(value.code());
+    }
+};
+}
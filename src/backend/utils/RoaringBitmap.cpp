@@ -0,0 +1,243 @@
+#include "RoaringBitmap.h"
+
+#include <algorithm>
+#include <bitset>
+#include <iterator>
+#include <utility>
+
+namespace {
+    const size_t kBitmapWords = 65536 / 64;
+
+    size_t popCount(uint64_t word) {
+        return std::bitset<64>(word).count();
+    }
+}
+
+bool RoaringBitmap::Chunk::contains(uint16_t low) const {
+    if (isBitmap())
+        return (bits[low / 64] >> (low % 64)) & 1;
+    return std::binary_search(values.begin(), values.end(), low);
+}
+
+void RoaringBitmap::toBitmap(Chunk& chunk) {
+    chunk.bits.assign(kBitmapWords, 0);
+    for (uint16_t low : chunk.values)
+        chunk.bits[low / 64] |= uint64_t(1) << (low % 64);
+    chunk.values.clear();
+    chunk.values.shrink_to_fit();
+}
+
+void RoaringBitmap::toArray(Chunk& chunk) {
+    chunk.values.clear();
+    chunk.values.reserve(chunk.count);
+    for (size_t w = 0; w < chunk.bits.size(); ++w) {
+        uint64_t word = chunk.bits[w];
+        while (word) {
+            chunk.values.push_back(static_cast<uint16_t>(w * 64 + lowestBit(word)));
+            word &= word - 1;
+        }
+    }
+    chunk.bits.clear();
+    chunk.bits.shrink_to_fit();
+}
+
+// Выбирает представление блока по числу значений
+void RoaringBitmap::normalize(Chunk& chunk) {
+    if (chunk.isBitmap() && chunk.count <= kArrayLimit)
+        toArray(chunk);
+    else if (!chunk.isBitmap() && chunk.count > kArrayLimit)
+        toBitmap(chunk);
+}
+
+std::vector<RoaringBitmap::Chunk>::iterator RoaringBitmap::findChunk(uint16_t key) {
+    return std::lower_bound(chunks.begin(), chunks.end(), key,
+                            [](const Chunk& chunk, uint16_t k) { return chunk.key < k; });
+}
+
+std::vector<RoaringBitmap::Chunk>::const_iterator RoaringBitmap::findChunk(uint16_t key) const {
+    return std::lower_bound(chunks.begin(), chunks.end(), key,
+                            [](const Chunk& chunk, uint16_t k) { return chunk.key < k; });
+}
+
+void RoaringBitmap::add(uint32_t value) {
+    uint16_t key = static_cast<uint16_t>(value >> 16);
+    uint16_t low = static_cast<uint16_t>(value);
+
+    auto it = findChunk(key);
+    if (it == chunks.end() || it->key != key) {
+        it = chunks.insert(it, Chunk());
+        it->key = key;
+    }
+
+    if (it->isBitmap()) {
+        uint64_t& word = it->bits[low / 64];
+        uint64_t mask = uint64_t(1) << (low % 64);
+        if (!(word & mask)) {
+            word |= mask;
+            ++it->count;
+        }
+        return;
+    }
+
+    auto pos = std::lower_bound(it->values.begin(), it->values.end(), low);
+    if (pos != it->values.end() && *pos == low)
+        return;
+    it->values.insert(pos, low);
+    ++it->count;
+    normalize(*it);
+}
+
+void RoaringBitmap::remove(uint32_t value) {
+    uint16_t key = static_cast<uint16_t>(value >> 16);
+    uint16_t low = static_cast<uint16_t>(value);
+
+    auto it = findChunk(key);
+    if (it == chunks.end() || it->key != key)
+        return;
+
+    if (it->isBitmap()) {
+        uint64_t& word = it->bits[low / 64];
+        uint64_t mask = uint64_t(1) << (low % 64);
+        if (!(word & mask))
+            return;
+        word &= ~mask;
+        --it->count;
+        normalize(*it);
+    }
+    else {
+        auto pos = std::lower_bound(it->values.begin(), it->values.end(), low);
+        if (pos == it->values.end() || *pos != low)
+            return;
+        it->values.erase(pos);
+        --it->count;
+    }
+
+    if (it->count == 0)
+        chunks.erase(it);
+}
+
+bool RoaringBitmap::contains(uint32_t value) const {
+    uint16_t key = static_cast<uint16_t>(value >> 16);
+    auto it = findChunk(key);
+    return it != chunks.end() && it->key == key && it->contains(static_cast<uint16_t>(value));
+}
+
+size_t RoaringBitmap::cardinality() const {
+    size_t total = 0;
+    for (const Chunk& chunk : chunks)
+        total += chunk.count;
+    return total;
+}
+
+RoaringBitmap::Chunk RoaringBitmap::intersect(const Chunk& a, const Chunk& b) {
+    Chunk result;
+    result.key = a.key;
+
+    if (a.isBitmap() && b.isBitmap()) {
+        result.bits.resize(kBitmapWords);
+        for (size_t w = 0; w < kBitmapWords; ++w) {
+            result.bits[w] = a.bits[w] & b.bits[w];
+            result.count += static_cast<uint32_t>(popCount(result.bits[w]));
+        }
+    }
+    else if (a.isBitmap() || b.isBitmap()) {
+        const Chunk& array = a.isBitmap() ? b : a;
+        const Chunk& bitmap = a.isBitmap() ? a : b;
+        for (uint16_t low : array.values) {
+            if (bitmap.contains(low))
+                result.values.push_back(low);
+        }
+        result.count = static_cast<uint32_t>(result.values.size());
+    }
+    else {
+        std::set_intersection(a.values.begin(), a.values.end(),
+                              b.values.begin(), b.values.end(),
+                              std::back_inserter(result.values));
+        result.count = static_cast<uint32_t>(result.values.size());
+    }
+
+    normalize(result);
+    return result;
+}
+
+RoaringBitmap::Chunk RoaringBitmap::unite(const Chunk& a, const Chunk& b) {
+    Chunk result;
+    result.key = a.key;
+
+    if (a.isBitmap() || b.isBitmap()) {
+        result = a.isBitmap() ? a : b;
+        const Chunk& other = a.isBitmap() ? b : a;
+        if (other.isBitmap()) {
+            for (size_t w = 0; w < kBitmapWords; ++w)
+                result.bits[w] |= other.bits[w];
+        }
+        else {
+            for (uint16_t low : other.values)
+                result.bits[low / 64] |= uint64_t(1) << (low % 64);
+        }
+        result.count = 0;
+        for (uint64_t word : result.bits)
+            result.count += static_cast<uint32_t>(popCount(word));
+    }
+    else {
+        result.values.reserve(a.values.size() + b.values.size());
+        std::set_union(a.values.begin(), a.values.end(),
+                       b.values.begin(), b.values.end(),
+                       std::back_inserter(result.values));
+        result.count = static_cast<uint32_t>(result.values.size());
+        normalize(result);
+    }
+
+    return result;
+}
+
+RoaringBitmap& RoaringBitmap::operator&=(const RoaringBitmap& other) {
+    std::vector<Chunk> result;
+    auto a = chunks.begin();
+    auto b = other.chunks.begin();
+
+    while (a != chunks.end() && b != other.chunks.end()) {
+        if (a->key < b->key) {
+            ++a;
+        }
+        else if (b->key < a->key) {
+            ++b;
+        }
+        else {
+            Chunk chunk = intersect(*a, *b);
+            if (chunk.count)
+                result.push_back(std::move(chunk));
+            ++a;
+            ++b;
+        }
+    }
+
+    chunks = std::move(result);
+    return *this;
+}
+
+RoaringBitmap& RoaringBitmap::operator|=(const RoaringBitmap& other) {
+    std::vector<Chunk> result;
+    result.reserve(chunks.size() + other.chunks.size());
+    auto a = chunks.begin();
+    auto b = other.chunks.begin();
+
+    while (a != chunks.end() || b != other.chunks.end()) {
+        if (b == other.chunks.end() || (a != chunks.end() && a->key < b->key)) {
+            result.push_back(std::move(*a));
+            ++a;
+        }
+        else if (a == chunks.end() || b->key < a->key) {
+            result.push_back(*b);
+            ++b;
+        }
+        else {
+            result.push_back(unite(*a, *b));
+            ++a;
+            ++b;
+        }
+    }
+
+    chunks = std::move(result);
+    return *this;
+}
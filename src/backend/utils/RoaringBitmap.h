@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Сжатое множество 32-битных чисел (ID записей) по схеме Roaring: числа
+// делятся на блоки по старшим 16 битам. Блок до kArrayLimit значений
+// хранит отсортированный массив младших 16 бит, более плотный - битовую
+// карту на 65536 бит (8 КБ). Пересечение и объединение идут поблочно
+// и для пар битовых карт сводятся к AND/OR по 64-битным словам.
+class RoaringBitmap {
+public:
+    static const size_t kArrayLimit = 4096;
+
+    void add(uint32_t value);
+    void remove(uint32_t value);
+    bool contains(uint32_t value) const;
+
+    bool empty() const { return chunks.empty(); }
+    size_t cardinality() const;
+    void clear() { chunks.clear(); }
+
+    RoaringBitmap& operator&=(const RoaringBitmap& other);
+    RoaringBitmap& operator|=(const RoaringBitmap& other);
+
+    friend RoaringBitmap operator&(RoaringBitmap a, const RoaringBitmap& b) { return a &= b; }
+    friend RoaringBitmap operator|(RoaringBitmap a, const RoaringBitmap& b) { return a |= b; }
+
+    // Вызывает f(value) для всех чисел по возрастанию
+    template <typename F>
+    void forEach(F f) const {
+        for (const Chunk& chunk : chunks) {
+            uint32_t high = uint32_t(chunk.key) << 16;
+            if (!chunk.isBitmap()) {
+                for (uint16_t low : chunk.values)
+                    f(high | low);
+                continue;
+            }
+            for (size_t w = 0; w < chunk.bits.size(); ++w) {
+                uint64_t word = chunk.bits[w];
+                while (word) {
+                    f(high | uint32_t(w * 64 + lowestBit(word)));
+                    word &= word - 1;
+                }
+            }
+        }
+    }
+
+private:
+    struct Chunk {
+        uint16_t key = 0;
+        uint32_t count = 0;
+        std::vector<uint16_t> values;   // блок-массив
+        std::vector<uint64_t> bits;     // блок-битовая карта (1024 слова)
+
+        bool isBitmap() const { return !bits.empty(); }
+        bool contains(uint16_t low) const;
+    };
+
+    std::vector<Chunk> chunks;  // по возрастанию key
+
+    static unsigned lowestBit(uint64_t word) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return index;
+#else
+        return __builtin_ctzll(word);
+#endif
+    }
+
+    static void toBitmap(Chunk& chunk);
+    static void toArray(Chunk& chunk);
+    static void normalize(Chunk& chunk);
+    static Chunk intersect(const Chunk& a, const Chunk& b);
+    static Chunk unite(const Chunk& a, const Chunk& b);
+
+    std::vector<Chunk>::iterator findChunk(uint16_t key);
+    std::vector<Chunk>::const_iterator findChunk(uint16_t key) const;
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Фиксированный пул рабочих потоков для фоновых задач хранилища
+// (декодирование разделов, шифрование блоков и т.п.).
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable available;
+    bool stopping = false;
+
+    void workerLoop();
+
+public:
+    explicit ThreadPool(size_t threadCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers.size(); }
+
+    template <typename Task>
+    auto submit(Task task) -> std::future<typename std::invoke_result<Task>::type> {
+        using Result = typename std::invoke_result<Task>::type;
+
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+        std::future<Result> result = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.emplace_back([packaged]() { (*packaged)(); });
+        }
+        available.notify_one();
+        return result;
+    }
+
+    // Общий пул на все ядра процессора
+    static ThreadPool& shared();
+};
+
+// Дожидается всех задач, затем возвращает результаты по порядку. Если задачи
+// завершились с ошибкой, пробрасывается первая из них - уже после того, как
+// остальные закончили работу с общими данными.
+template <typename Result>
+std::vector<Result> waitAll(std::vector<std::future<Result>>& futures) {
+    for (auto& future : futures)
+        future.wait();
+
+    std::vector<Result> results;
+    results.reserve(futures.size());
+    for (auto& future : futures)
+        results.push_back(future.get());
+    return results;
+}
+
+inline void waitAll(std::vector<std::future<void>>& futures) {
+    for (auto& future : futures)
+        future.wait();
+    for (auto& future : futures)
+        future.get();
+}
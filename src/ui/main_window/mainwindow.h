@@ -10,6 +10,7 @@
 
 class ApplicationController;  // forward declaration
 class QCloseEvent;
+class QTimer;
 class EmployeesTabWidget;
 class ComputersTabWidget;
 class StatsTabWidget;
@@ -41,11 +42,15 @@ private slots:
     void onNewDatabase();
     void onOpenDatabase();
     void onSaveDatabase();
+    void onAutosaveToggled(bool enabled);
+    void onAutosaveTimer();
 
 private:
     QAction* actionNew;
     QAction* actionOpen;
     QAction* actionSave;
+    QAction* actionAutosave;
+    QTimer* autosaveTimer;
 
     ApplicationController* controller;
 
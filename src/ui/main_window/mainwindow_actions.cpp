@@ -6,6 +6,8 @@
 #include <QInputDialog>
 #include <QLineEdit>
 #include <QMessageBox>
+#include <QStatusBar>
+#include <QTimer>
 
 #include <exception>
 
@@ -133,3 +135,25 @@ void MainWindow::onSaveDatabase()
         QMessageBox::critical(this, "Ошибка", ex.what());
     }
 }
+
+void MainWindow::onAutosaveToggled(bool enabled)
+{
+    if (enabled)
+        autosaveTimer->start();
+    else
+        autosaveTimer->stop();
+}
+
+void MainWindow::onAutosaveTimer()
+{
+    // Автосохранение пишет в файл, открытый или сохраненный последним;
+    // пока файл не выбран, startAutosave ничего не делает. Ошибка прошлой
+    // фоновой записи приходит отсюда же.
+    try {
+        if (controller->startAutosave())
+            statusBar()->showMessage("Автосохранение...", 2000);
+    }
+    catch (const std::exception& ex) {
+        statusBar()->showMessage(QString("Ошибка автосохранения: ") + ex.what());
+    }
+}
@@ -8,11 +8,15 @@
 #include <QStatusBar>
 #include <QToolBar>
 #include <QMenu>
+#include <QTimer>
 
 #include "ui/tabs/EmployeesTabWidget.h"
 #include "ui/tabs/ComputersTabWidget.h"
 #include "ui/tabs/StatsTabWidget.h"
 
+// Интервал автосохранения; запись идет в фоне, таймер только запускает ее
+static const int kAutosaveIntervalMs = 60 * 1000;
+
 void MainWindow::setupUi()
 {
     resize(1000, 600);
@@ -65,14 +69,23 @@ void MainWindow::setupMenu()
     actionNew = new QAction("Создать", this);
     actionOpen = new QAction("Открыть", this);
     actionSave = new QAction("Сохранить", this);
+    actionAutosave = new QAction("Автосохранение", this);
+    actionAutosave->setCheckable(true);
 
     fileMenu->addAction(actionNew);
     fileMenu->addAction(actionOpen);
     fileMenu->addAction(actionSave);
+    fileMenu->addSeparator();
+    fileMenu->addAction(actionAutosave);
+
+    autosaveTimer = new QTimer(this);
+    autosaveTimer->setInterval(kAutosaveIntervalMs);
 
     connect(actionNew, &QAction::triggered, this, &MainWindow::onNewDatabase);
     connect(actionOpen, &QAction::triggered, this, &MainWindow::onOpenDatabase);
     connect(actionSave, &QAction::triggered, this, &MainWindow::onSaveDatabase);
+    connect(actionAutosave, &QAction::toggled, this, &MainWindow::onAutosaveToggled);
+    connect(autosaveTimer, &QTimer::timeout, this, &MainWindow::onAutosaveTimer);
 }
 
 void MainWindow::setupEmployeesTab()
@@ -16,10 +16,11 @@
 #include <QComboBox>
 #include <QLabel>
 #include <QSpinBox>
-#include <QDate>
 #include <QSignalBlocker>
+#include <QVariant>
 
 #include <algorithm>
+#include <cstdint>
 #include <cstdlib>
 #include <string>
 #include <exception>
@@ -27,21 +28,76 @@
 
 #include "backend/models/Employee.h"
 #include "backend/models/Computer.h"
+#include "backend/utils/DateUtils.h"
 #include "ui/dialogs/ComputerDialog.h"
 
 namespace {
-QDate parseUiDate(const std::string& value)
+QString safeText(const std::string& value)
 {
-    QString text = QString::fromStdString(value).trimmed();
-    if (text.isEmpty())
-        return QDate();
+    return value.empty() ? QString("-") : QString::fromStdString(value);
+}
 
-    return QDate::fromString(text, "dd.MM.yyyy");
+QString ownerText(const Employee* owner)
+{
+    if (!owner)
+        return "-";
+
+    QString initials = QString::fromStdString(owner->initials);
+    QString name = QString::fromStdString(owner->lastName);
+    if (!initials.isEmpty())
+        name += " " + initials;
+    return "ID: " + QString::number(owner->id) + " | " + name;
 }
 
-QString safeText(const std::string& value)
+// Заполняет список значений фильтра, сохраняя выбранное значение.
+// Значение поля хранится в данных элемента как есть: по нему ведется отбор,
+// а значения, отличающиеся только пробелами по краям, остаются разными
+// элементами (такие показываются в кавычках, чтобы их можно было различить)
+void fillCategoryFilter(QComboBox* filter,
+                        const QString& allText,
+                        const std::vector<InternedString>& codes)
 {
-    return value.empty() ? QString("-") : QString::fromStdString(value);
+    struct Item {
+        QString label;
+        QString value;
+    };
+
+    std::vector<Item> items;
+    items.reserve(codes.size());
+    for (const auto& code : codes) {
+        QString value = QString::fromStdString(code.str());
+        if (value.isEmpty())
+            continue;
+        QString label = value.trimmed();
+        if (label != value)
+            label = "\"" + value + "\"";
+        items.push_back({ label, value });
+    }
+
+    std::sort(items.begin(), items.end(),
+              [](const Item& left, const Item& right) {
+                  int order = QString::localeAwareCompare(left.label, right.label);
+                  return order != 0 ? order < 0 : left.value < right.value;
+              });
+
+    QVariant selected = filter->currentIndex() > 0 ? filter->currentData() : QVariant();
+    QSignalBlocker blocker(filter);
+    filter->clear();
+    filter->addItem(allText);
+    for (const auto& item : items)
+        filter->addItem(item.label, item.value);
+
+    int idx = selected.isValid() ? filter->findData(selected) : -1;
+    filter->setCurrentIndex(idx >= 0 ? idx : 0);
+}
+
+// Выбранное значение фильтра; false - выбран первый элемент ("Все ...")
+bool selectedCategory(const QComboBox* filter, InternedString& value)
+{
+    if (filter->currentIndex() <= 0)
+        return false;
+    value = InternedString(filter->currentData().toString().toStdString());
+    return true;
 }
 }
 
@@ -57,6 +113,10 @@ ComputersTabWidget::ComputersTabWidget(ApplicationController* controller,
     maxStorageFilter = new QSpinBox();
     serviceFilter = new QComboBox();
     sortFilter = new QComboBox();
+    manufacturerFilter = new QComboBox();
+    storageTypeFilter = new QComboBox();
+    roomFilter = new QComboBox();
+    conditionFilter = new QComboBox();
 
     maxRamFilter->setRange(0, 2048);
     maxRamFilter->setValue(0);
@@ -75,6 +135,11 @@ ComputersTabWidget::ComputersTabWidget(ApplicationController* controller,
 
     sortFilter->addItems({"RAM", "Диск", "Дата ТО", "Модель", "Инвентарный"});
 
+    manufacturerFilter->addItem("Все производители");
+    storageTypeFilter->addItem("Все накопители");
+    roomFilter->addItem("Все аудитории");
+    conditionFilter->addItem("Все состояния");
+
     btnResetFilters = new QPushButton("Сброс фильтров");
     btnFullTable = new QPushButton("Полная таблица");
 
@@ -89,7 +154,19 @@ ComputersTabWidget::ComputersTabWidget(ApplicationController* controller,
     filtersLayout->addWidget(btnResetFilters);
     filtersLayout->addWidget(btnFullTable);
 
+    QHBoxLayout* categoryFiltersLayout = new QHBoxLayout();
+    categoryFiltersLayout->addWidget(new QLabel("Производитель:"));
+    categoryFiltersLayout->addWidget(manufacturerFilter);
+    categoryFiltersLayout->addWidget(new QLabel("Накопитель:"));
+    categoryFiltersLayout->addWidget(storageTypeFilter);
+    categoryFiltersLayout->addWidget(new QLabel("Аудитория:"));
+    categoryFiltersLayout->addWidget(roomFilter);
+    categoryFiltersLayout->addWidget(new QLabel("Состояние:"));
+    categoryFiltersLayout->addWidget(conditionFilter);
+    categoryFiltersLayout->addStretch();
+
     layout->addLayout(filtersLayout);
+    layout->addLayout(categoryFiltersLayout);
 
     table = new QTableWidget();
     table->setColumnCount(4);
@@ -143,6 +220,14 @@ ComputersTabWidget::ComputersTabWidget(ApplicationController* controller,
             this, &ComputersTabWidget::onFilterChanged);
     connect(sortFilter, &QComboBox::currentTextChanged,
             this, &ComputersTabWidget::onFilterChanged);
+    connect(manufacturerFilter, &QComboBox::currentTextChanged,
+            this, &ComputersTabWidget::onFilterChanged);
+    connect(storageTypeFilter, &QComboBox::currentTextChanged,
+            this, &ComputersTabWidget::onFilterChanged);
+    connect(roomFilter, &QComboBox::currentTextChanged,
+            this, &ComputersTabWidget::onFilterChanged);
+    connect(conditionFilter, &QComboBox::currentTextChanged,
+            this, &ComputersTabWidget::onFilterChanged);
 
     connect(btnResetFilters, &QPushButton::clicked,
             this, &ComputersTabWidget::onResetFilters);
@@ -176,6 +261,23 @@ void ComputersTabWidget::setButtonsEnabled(bool enabled)
     maxStorageFilter->setEnabled(enabled);
     serviceFilter->setEnabled(enabled);
     sortFilter->setEnabled(enabled);
+    manufacturerFilter->setEnabled(enabled);
+    storageTypeFilter->setEnabled(enabled);
+    roomFilter->setEnabled(enabled);
+    conditionFilter->setEnabled(enabled);
+}
+
+void ComputersTabWidget::refreshFilterValues()
+{
+    // Различные значения берутся из индексов базы, а не из каждой строки
+    fillCategoryFilter(manufacturerFilter, "Все производители",
+                       controller->categoryValues(ComputerCategory::Manufacturer));
+    fillCategoryFilter(storageTypeFilter, "Все накопители",
+                       controller->categoryValues(ComputerCategory::StorageType));
+    fillCategoryFilter(roomFilter, "Все аудитории",
+                       controller->categoryValues(ComputerCategory::RoomNumber));
+    fillCategoryFilter(conditionFilter, "Все состояния",
+                       controller->categoryValues(ComputerCategory::Condition));
 }
 
 void ComputersTabWidget::rebuildTable()
@@ -191,97 +293,112 @@ void ComputersTabWidget::rebuildTable()
         return;
     }
 
+    refreshFilterValues();
+
     const auto& computers = controller->getComputers();
-    const auto& employees = controller->getEmployees();
 
     int ramLimit = maxRamFilter->value();
     int storageLimit = maxStorageFilter->value();
     QString serviceCriterion = serviceFilter->currentText();
     QString sortCriterion = sortFilter->currentText();
-    QDate today = QDate::currentDate();
+    date_utils::DayNumber today = date_utils::today();
+
+    // Числовые условия отбираются по столбцам базы, текстовый фильтр
+    // проверяется только у прошедших их записей
+    std::vector<ComputerRange> ranges;
+    if (ramLimit > 0)
+        ranges.push_back({ ComputerColumn::Ram, INT32_MIN, ramLimit });
+    if (storageLimit > 0)
+        ranges.push_back({ ComputerColumn::Storage, INT32_MIN, storageLimit });
+
+    // Дата ТО разобрана базой заранее: сравниваются номера дней,
+    // пустая или неверная дата - номер не больше kNoDate
+    if (serviceCriterion == "Просрочено ТО (до сегодня)")
+        ranges.push_back({ ComputerColumn::LastMaintenanceDay, date_utils::kNoDate + 1, today });
+    else if (serviceCriterion == "ТО в ближайшие 30 дней")
+        ranges.push_back({ ComputerColumn::LastMaintenanceDay, today, today + 30 });
+    else if (serviceCriterion == "Без даты ТО")
+        ranges.push_back({ ComputerColumn::LastMaintenanceDay, INT32_MIN, date_utils::kNoDate });
+
+    // Фильтры по значению - объединение и пересечение битовых карт индексов
+    std::vector<ComputerCategoryFilter> categories;
+    auto addCategory = [&](ComputerCategory category, QComboBox* filter) {
+        InternedString value;
+        if (selectedCategory(filter, value))
+            categories.push_back({ category, { value } });
+    };
+    addCategory(ComputerCategory::Manufacturer, manufacturerFilter);
+    addCategory(ComputerCategory::StorageType, storageTypeFilter);
+    addCategory(ComputerCategory::RoomNumber, roomFilter);
+    addCategory(ComputerCategory::Condition, conditionFilter);
+
+    column_scan::Selection selection = controller->selectComputers(ranges, categories);
 
     std::vector<const Computer*> filtered;
-    filtered.reserve(computers.size());
+    filtered.reserve(selection.count());
+
+    auto matchesText = [&](const Computer& c) {
+        if (currentFilter.isEmpty())
+            return true;
 
-    for (const auto& c : computers) {
         QString model = QString::fromStdString(c.model);
         QString inventory = QString::fromStdString(c.inventoryNumber);
         QString serial = QString::fromStdString(c.serialNumber);
 
-        if (!currentFilter.isEmpty() &&
-            !model.contains(currentFilter, Qt::CaseInsensitive) &&
-            !inventory.contains(currentFilter, Qt::CaseInsensitive) &&
-            !serial.contains(currentFilter, Qt::CaseInsensitive))
-            continue;
-
-        if (ramLimit > 0 && c.ramSize > ramLimit)
-            continue;
-
-        if (storageLimit > 0 && c.storageSize > storageLimit)
-            continue;
-
-        QDate maintenanceDate = parseUiDate(c.lastMaintenanceDate);
+        return model.contains(currentFilter, Qt::CaseInsensitive) ||
+               inventory.contains(currentFilter, Qt::CaseInsensitive) ||
+               serial.contains(currentFilter, Qt::CaseInsensitive);
+    };
 
-        if (serviceCriterion == "Просрочено ТО (до сегодня)") {
-            if (!maintenanceDate.isValid() || maintenanceDate > today)
-                continue;
-        }
-        else if (serviceCriterion == "ТО в ближайшие 30 дней") {
-            if (!maintenanceDate.isValid() ||
-                maintenanceDate < today ||
-                maintenanceDate > today.addDays(30))
-                continue;
-        }
-        else if (serviceCriterion == "Без даты ТО") {
-            if (maintenanceDate.isValid())
-                continue;
+    auto appendInOrder = [&](const std::vector<int>& ids) {
+        for (int id : ids) {
+            const Computer* c = controller->findComputerById(id);
+            if (c && matchesText(*c))
+                filtered.push_back(c);
         }
+    };
 
-        filtered.push_back(&c);
+    // Числовые сортировки берут порядок из индексов базы (значение, затем ID)
+    if (sortCriterion == "RAM") {
+        appendInOrder(controller->findComputerIdsInRange({ ComputerColumn::Ram, INT32_MIN, INT32_MAX }, selection));
     }
-
-    std::sort(filtered.begin(), filtered.end(),
-              [&](const Computer* left, const Computer* right) {
-                  if (sortCriterion == "RAM") {
-                      if (left->ramSize == right->ramSize)
-                          return left->id < right->id;
-                      return left->ramSize < right->ramSize;
-                  }
-
-                  if (sortCriterion == "Диск") {
-                      if (left->storageSize == right->storageSize)
-                          return left->id < right->id;
-                      return left->storageSize < right->storageSize;
-                  }
-
-                  if (sortCriterion == "Дата ТО") {
-                      QDate l = parseUiDate(left->lastMaintenanceDate);
-                      QDate r = parseUiDate(right->lastMaintenanceDate);
-                      if (!l.isValid() && !r.isValid())
-                          return left->id < right->id;
-                      if (!l.isValid())
-                          return false;
-                      if (!r.isValid())
-                          return true;
-                      if (l == r)
-                          return left->id < right->id;
-                      return l < r;
-                  }
-
-                  if (sortCriterion == "Инвентарный") {
-                      QString l = QString::fromStdString(left->inventoryNumber);
-                      QString r = QString::fromStdString(right->inventoryNumber);
+    else if (sortCriterion == "Диск") {
+        appendInOrder(controller->findComputerIdsInRange({ ComputerColumn::Storage, INT32_MIN, INT32_MAX }, selection));
+    }
+    else if (sortCriterion == "Дата ТО") {
+        // Сначала заполненные даты по возрастанию, затем без даты по ID
+        appendInOrder(controller->findComputerIdsInRange(
+            { ComputerColumn::LastMaintenanceDay, date_utils::kNoDate + 1, INT32_MAX }, selection));
+
+        size_t withDate = filtered.size();
+        appendInOrder(controller->findComputerIdsInRange(
+            { ComputerColumn::LastMaintenanceDay, INT32_MIN, date_utils::kNoDate }, selection));
+        std::sort(filtered.begin() + withDate, filtered.end(),
+                  [](const Computer* left, const Computer* right) { return left->id < right->id; });
+    }
+    else {
+        selection.forEach([&](size_t slot) {
+            if (matchesText(computers[slot]))
+                filtered.push_back(&computers[slot]);
+        });
+
+        std::sort(filtered.begin(), filtered.end(),
+                  [&](const Computer* left, const Computer* right) {
+                      if (sortCriterion == "Инвентарный") {
+                          QString l = QString::fromStdString(left->inventoryNumber);
+                          QString r = QString::fromStdString(right->inventoryNumber);
+                          if (l == r)
+                              return left->id < right->id;
+                          return QString::localeAwareCompare(l, r) < 0;
+                      }
+
+                      QString l = QString::fromStdString(left->model);
+                      QString r = QString::fromStdString(right->model);
                       if (l == r)
                           return left->id < right->id;
                       return QString::localeAwareCompare(l, r) < 0;
-                  }
-
-                  QString l = QString::fromStdString(left->model);
-                  QString r = QString::fromStdString(right->model);
-                  if (l == r)
-                      return left->id < right->id;
-                  return QString::localeAwareCompare(l, r) < 0;
-              });
+                  });
+    }
 
     int row = 0;
     for (const auto* c : filtered) {
@@ -293,21 +410,8 @@ void ComputersTabWidget::rebuildTable()
         table->setItem(row, 2,
             new QTableWidgetItem(QString::number(c->ramSize)));
 
-        QString empText = "-";
-        for (const auto& e : employees) {
-            if (e.computerId.has_value() &&
-                e.computerId.value() == c->id) {
-                QString initials = QString::fromStdString(e.initials);
-                QString name = QString::fromStdString(e.lastName);
-                if (!initials.isEmpty())
-                    name += " " + initials;
-                empText = "ID: " + QString::number(e.id) + " | " + name;
-                break;
-            }
-        }
-
         table->setItem(row, 3,
-            new QTableWidgetItem(empText));
+            new QTableWidgetItem(ownerText(controller->ownerOf(c->id))));
         row++;
     }
 
@@ -376,15 +480,7 @@ void ComputersTabWidget::onEditComputer()
 
     int id = table->item(row, 0)->text().toInt();
 
-    const auto& computers = controller->getComputers();
-    const Computer* current = nullptr;
-    for (const auto& c : computers) {
-        if (c.id == id) {
-            current = &c;
-            break;
-        }
-    }
-
+    const Computer* current = controller->findComputerById(id);
     if (!current) {
         QMessageBox::warning(this, "Ошибка", "ПК не найден");
         return;
@@ -502,11 +598,19 @@ void ComputersTabWidget::onResetFilters()
         QSignalBlocker b2(maxStorageFilter);
         QSignalBlocker b3(serviceFilter);
         QSignalBlocker b4(sortFilter);
+        QSignalBlocker b5(manufacturerFilter);
+        QSignalBlocker b6(storageTypeFilter);
+        QSignalBlocker b7(roomFilter);
+        QSignalBlocker b8(conditionFilter);
 
         maxRamFilter->setValue(0);
         maxStorageFilter->setValue(0);
         serviceFilter->setCurrentIndex(0);
         sortFilter->setCurrentIndex(0);
+        manufacturerFilter->setCurrentIndex(0);
+        storageTypeFilter->setCurrentIndex(0);
+        roomFilter->setCurrentIndex(0);
+        conditionFilter->setCurrentIndex(0);
     }
 
     rebuildTable();
@@ -533,25 +637,12 @@ void ComputersTabWidget::onShowFullTable()
     fullTable->horizontalHeader()->setStretchLastSection(true);
 
     const auto& computers = controller->getComputers();
-    const auto& employees = controller->getEmployees();
 
     fullTable->setRowCount(static_cast<int>(computers.size()));
 
     for (int row = 0; row < static_cast<int>(computers.size()); ++row) {
         const auto& c = computers[row];
 
-        QString empText = "-";
-        for (const auto& e : employees) {
-            if (e.computerId.has_value() && e.computerId.value() == c.id) {
-                QString initials = QString::fromStdString(e.initials);
-                QString name = QString::fromStdString(e.lastName);
-                if (!initials.isEmpty())
-                    name += " " + initials;
-                empText = "ID: " + QString::number(e.id) + " | " + name;
-                break;
-            }
-        }
-
         fullTable->setItem(row, 0, new QTableWidgetItem(QString::number(c.id)));
         fullTable->setItem(row, 1, new QTableWidgetItem(safeText(c.inventoryNumber)));
         fullTable->setItem(row, 2, new QTableWidgetItem(safeText(c.serialNumber)));
@@ -567,7 +658,7 @@ void ComputersTabWidget::onShowFullTable()
         fullTable->setItem(row, 12, new QTableWidgetItem(safeText(c.commissioningDate)));
         fullTable->setItem(row, 13, new QTableWidgetItem(safeText(c.lastMaintenanceDate)));
         fullTable->setItem(row, 14, new QTableWidgetItem(safeText(c.warrantyExpirationDate)));
-        fullTable->setItem(row, 15, new QTableWidgetItem(empText));
+        fullTable->setItem(row, 15, new QTableWidgetItem(ownerText(controller->ownerOf(c.id))));
     }
 
     layout->addWidget(fullTable);
@@ -593,17 +684,8 @@ void ComputersTabWidget::updateDetails()
     }
 
     int id = table->item(row, 0)->text().toInt();
-    const auto& computers = controller->getComputers();
-    const auto& employees = controller->getEmployees();
-
-    const Computer* comp = nullptr;
-    for (const auto& c : computers) {
-        if (c.id == id) {
-            comp = &c;
-            break;
-        }
-    }
 
+    const Computer* comp = controller->findComputerById(id);
     if (!comp) {
         details->setText("ПК не найден");
         return;
@@ -626,19 +708,7 @@ void ComputersTabWidget::updateDetails()
     text += "Дата обслуживания: " + safeText(comp->lastMaintenanceDate) + "\n";
     text += "Гарантия до: " + safeText(comp->warrantyExpirationDate) + "\n";
 
-    QString empText = "-";
-    for (const auto& e : employees) {
-        if (e.computerId.has_value() &&
-            e.computerId.value() == comp->id) {
-            QString initials = QString::fromStdString(e.initials);
-            QString name = QString::fromStdString(e.lastName);
-            if (!initials.isEmpty())
-                name += " " + initials;
-            empText = "ID: " + QString::number(e.id) + " | " + name;
-            break;
-        }
-    }
-    text += "Сотрудник: " + empText;
+    text += "Сотрудник: " + ownerText(controller->ownerOf(comp->id));
 
     details->setText(text);
 }
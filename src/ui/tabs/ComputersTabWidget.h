@@ -38,6 +38,7 @@ private slots:
 
 private:
     void rebuildTable();
+    void refreshFilterValues();
     void updateDetails();
     void setButtonsEnabled(bool enabled);
 
@@ -58,4 +59,8 @@ private:
     QSpinBox* maxStorageFilter;
     QComboBox* serviceFilter;
     QComboBox* sortFilter;
+    QComboBox* manufacturerFilter;
+    QComboBox* storageTypeFilter;
+    QComboBox* roomFilter;
+    QComboBox* conditionFilter;
 };
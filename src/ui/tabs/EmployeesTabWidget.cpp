@@ -17,8 +17,10 @@
 #include <QComboBox>
 #include <QLabel>
 #include <QSignalBlocker>
+#include <QVariant>
 
 #include <algorithm>
+#include <cstdint>
 #include <exception>
 #include <vector>
 
@@ -26,6 +28,59 @@
 #include "backend/models/Computer.h"
 #include "ui/dialogs/EmployeeDialog.h"
 
+namespace {
+// Заполняет список значений фильтра, сохраняя выбранное значение.
+// Значение поля хранится в данных элемента как есть: по нему ведется отбор,
+// а значения, отличающиеся только пробелами по краям, остаются разными
+// элементами (такие показываются в кавычках, чтобы их можно было различить)
+void fillCategoryFilter(QComboBox* filter,
+                        const QString& allText,
+                        const std::vector<InternedString>& codes)
+{
+    struct Item {
+        QString label;
+        QString value;
+    };
+
+    std::vector<Item> items;
+    items.reserve(codes.size());
+    for (const auto& code : codes) {
+        QString value = QString::fromStdString(code.str());
+        if (value.isEmpty())
+            continue;
+        QString label = value.trimmed();
+        if (label != value)
+            label = "\"" + value + "\"";
+        items.push_back({ label, value });
+    }
+
+    std::sort(items.begin(), items.end(),
+              [](const Item& left, const Item& right) {
+                  int order = QString::localeAwareCompare(left.label, right.label);
+                  return order != 0 ? order < 0 : left.value < right.value;
+              });
+
+    QVariant selected = filter->currentIndex() > 0 ? filter->currentData() : QVariant();
+    QSignalBlocker blocker(filter);
+    filter->clear();
+    filter->addItem(allText);
+    for (const auto& item : items)
+        filter->addItem(item.label, item.value);
+
+    int idx = selected.isValid() ? filter->findData(selected) : -1;
+    filter->setCurrentIndex(idx >= 0 ? idx : 0);
+}
+
+// Выбранное значение фильтра; false - выбран первый элемент ("Все ...")
+bool selectedCategory(const QComboBox* filter, InternedString& value)
+{
+    if (filter->currentIndex() <= 0)
+        return false;
+    value = InternedString(filter->currentData().toString().toStdString());
+    return true;
+}
+}
+
 EmployeesTabWidget::EmployeesTabWidget(ApplicationController* controller,
                                        QWidget* parent)
     : QWidget(parent),
@@ -41,7 +96,9 @@ EmployeesTabWidget::EmployeesTabWidget(ApplicationController* controller,
 
     instituteFilter->addItem("Все институты");
     departmentFilter->addItem("Все кафедры");
-    statusFilter->addItems({"Все статусы", "Активен", "Уволен"});
+    statusFilter->addItem("Все статусы");
+    statusFilter->addItem("Активен", "Активен");
+    statusFilter->addItem("Уволен", "Уволен");
     sortFilter->addItems({"Фамилия", "Институт", "Кафедра", "Должность", "Статус"});
 
     btnResetFilters = new QPushButton("Сброс фильтров");
@@ -145,74 +202,14 @@ void EmployeesTabWidget::setButtonsEnabled(bool enabled)
 
 void EmployeesTabWidget::refreshFilterValues()
 {
-    const auto& employees = controller->getEmployees();
-
-    QString selectedInstitute = instituteFilter->currentText();
-    QString selectedDepartment = departmentFilter->currentText();
-    QString selectedStatus = statusFilter->currentText();
-
-    std::vector<QString> institutes;
-    std::vector<QString> departments;
-    std::vector<QString> statuses;
-
-    for (const auto& e : employees) {
-        QString institute = QString::fromStdString(e.institute).trimmed();
-        if (!institute.isEmpty())
-            institutes.push_back(institute);
-
-        QString department = QString::fromStdString(e.department).trimmed();
-        if (!department.isEmpty())
-            departments.push_back(department);
-
-        QString status = QString::fromStdString(e.status).trimmed();
-        if (!status.isEmpty())
-            statuses.push_back(status);
-    }
-
-    auto prepareUnique = [](std::vector<QString>& values) {
-        std::sort(values.begin(), values.end(),
-                  [](const QString& left, const QString& right) {
-                      return QString::localeAwareCompare(left, right) < 0;
-                  });
-        values.erase(std::unique(values.begin(), values.end()), values.end());
-    };
-
-    prepareUnique(institutes);
-    prepareUnique(departments);
-    prepareUnique(statuses);
-
-    {
-        QSignalBlocker b1(instituteFilter);
-        instituteFilter->clear();
-        instituteFilter->addItem("Все институты");
-        for (const auto& value : institutes)
-            instituteFilter->addItem(value);
-
-        int idx = instituteFilter->findText(selectedInstitute);
-        instituteFilter->setCurrentIndex(idx >= 0 ? idx : 0);
-    }
-
-    {
-        QSignalBlocker b2(departmentFilter);
-        departmentFilter->clear();
-        departmentFilter->addItem("Все кафедры");
-        for (const auto& value : departments)
-            departmentFilter->addItem(value);
-
-        int idx = departmentFilter->findText(selectedDepartment);
-        departmentFilter->setCurrentIndex(idx >= 0 ? idx : 0);
-    }
-
-    {
-        QSignalBlocker b3(statusFilter);
-        statusFilter->clear();
-        statusFilter->addItem("Все статусы");
-        for (const auto& value : statuses)
-            statusFilter->addItem(value);
-
-        int idx = statusFilter->findText(selectedStatus);
-        statusFilter->setCurrentIndex(idx >= 0 ? idx : 0);
-    }
+    // Различные значения берутся из индексов базы, поэтому в QString
+    // переводятся только они, а не поле каждой строки
+    fillCategoryFilter(instituteFilter, "Все институты",
+                       controller->categoryValues(EmployeeCategory::Institute));
+    fillCategoryFilter(departmentFilter, "Все кафедры",
+                       controller->categoryValues(EmployeeCategory::Department));
+    fillCategoryFilter(statusFilter, "Все статусы",
+                       controller->categoryValues(EmployeeCategory::Status));
 }
 
 void EmployeesTabWidget::rebuildTable()
@@ -231,42 +228,52 @@ void EmployeesTabWidget::rebuildTable()
     refreshFilterValues();
 
     const auto& employees = controller->getEmployees();
-    const auto& computers = controller->getComputers();
 
     std::vector<const Employee*> filtered;
     filtered.reserve(employees.size());
 
-    QString instituteCriterion = instituteFilter->currentText();
-    QString departmentCriterion = departmentFilter->currentText();
-    QString statusCriterion = statusFilter->currentText();
     QString sortCriterion = sortFilter->currentText();
 
-    for (const auto& e : employees) {
-        QString lastName = QString::fromStdString(e.lastName);
-        QString position = QString::fromStdString(e.position);
-        QString institute = QString::fromStdString(e.institute);
-        QString department = QString::fromStdString(e.department);
-        QString email = QString::fromStdString(e.email);
-
-        if (!currentFilter.isEmpty() &&
-            !lastName.contains(currentFilter, Qt::CaseInsensitive) &&
-            !position.contains(currentFilter, Qt::CaseInsensitive) &&
-            !institute.contains(currentFilter, Qt::CaseInsensitive) &&
-            !department.contains(currentFilter, Qt::CaseInsensitive) &&
-            !email.contains(currentFilter, Qt::CaseInsensitive))
-            continue;
-
-        if (instituteCriterion != "Все институты" && institute != instituteCriterion)
-            continue;
-
-        if (departmentCriterion != "Все кафедры" && department != departmentCriterion)
-            continue;
-
-        QString status = QString::fromStdString(e.status);
-        if (statusCriterion != "Все статусы" && status != statusCriterion)
-            continue;
+    // Фильтры по значению считаются пересечением битовых карт индексов
+    // базы; поиск по тексту проверяет только попавшие в них записи
+    std::vector<EmployeeCategoryFilter> categories;
+    auto addCategory = [&](EmployeeCategory category, QComboBox* filter) {
+        InternedString value;
+        if (selectedCategory(filter, value))
+            categories.push_back({ category, { value } });
+    };
+    addCategory(EmployeeCategory::Institute, instituteFilter);
+    addCategory(EmployeeCategory::Department, departmentFilter);
+    addCategory(EmployeeCategory::Status, statusFilter);
+
+    auto addIfMatches = [&](const Employee& e) {
+        if (!currentFilter.isEmpty()) {
+            QString lastName = QString::fromStdString(e.lastName);
+            QString position = QString::fromStdString(e.position);
+            QString instituteText = QString::fromStdString(e.institute);
+            QString departmentText = QString::fromStdString(e.department);
+            QString email = QString::fromStdString(e.email);
+
+            if (!lastName.contains(currentFilter, Qt::CaseInsensitive) &&
+                !position.contains(currentFilter, Qt::CaseInsensitive) &&
+                !instituteText.contains(currentFilter, Qt::CaseInsensitive) &&
+                !departmentText.contains(currentFilter, Qt::CaseInsensitive) &&
+                !email.contains(currentFilter, Qt::CaseInsensitive))
+                return;
+        }
 
         filtered.push_back(&e);
+    };
+
+    if (categories.empty()) {
+        for (const auto& e : employees)
+            addIfMatches(e);
+    }
+    else {
+        controller->selectEmployeeIds(categories).forEach([&](uint32_t id) {
+            if (const Employee* e = controller->findEmployeeById(static_cast<int>(id)))
+                addIfMatches(*e);
+        });
     }
 
     auto compareTextField = [](const QString& left, const QString& right) {
@@ -318,15 +325,11 @@ void EmployeesTabWidget::rebuildTable()
         QString pcText = "-";
 
         if (e->computerId.has_value()) {
-            int compId = e->computerId.value();
-            for (const auto& c : computers) {
-                if (c.id == compId) {
-                    pcText = "ID: " + QString::number(c.id) +
-                             " | " + QString::fromStdString(c.inventoryNumber) +
-                             " | " + QString::fromStdString(c.serialNumber) +
-                             " | " + QString::fromStdString(c.model);
-                    break;
-                }
+            if (const Computer* c = controller->findComputerById(e->computerId.value())) {
+                pcText = "ID: " + QString::number(c->id) +
+                         " | " + QString::fromStdString(c->inventoryNumber) +
+                         " | " + QString::fromStdString(c->serialNumber) +
+                         " | " + QString::fromStdString(c->model);
             }
         }
 
@@ -355,7 +358,10 @@ void EmployeesTabWidget::onAddEmployee()
     e.employmentDate = "";
 
     try {
-        controller->addEmployee(e);
+        if (controller->addEmployee(e) == 0) {
+            QMessageBox::critical(this, "Ошибка", "Компьютер уже назначен другому сотруднику");
+            return;
+        }
     }
     catch (const std::exception& ex) {
         QMessageBox::critical(this, "Ошибка", ex.what());
@@ -378,15 +384,7 @@ void EmployeesTabWidget::onEditEmployee()
 
     int id = table->item(row, 0)->text().toInt();
 
-    const auto& employees = controller->getEmployees();
-    const Employee* current = nullptr;
-    for (const auto& e : employees) {
-        if (e.id == id) {
-            current = &e;
-            break;
-        }
-    }
-
+    const Employee* current = controller->findEmployeeById(id);
     if (!current) {
         QMessageBox::warning(this, "Ошибка", "Сотрудник не найден");
         return;
@@ -403,7 +401,8 @@ void EmployeesTabWidget::onEditEmployee()
 
     try {
         if (!controller->updateEmployee(updated)) {
-            QMessageBox::critical(this, "Ошибка", "Не удалось обновить сотрудника");
+            QMessageBox::critical(this, "Ошибка",
+                                  "Не удалось обновить сотрудника: он удален или его компьютер назначен другому");
             return;
         }
     }
@@ -450,14 +449,12 @@ void EmployeesTabWidget::onAssignPc()
 
     int empId = table->item(row, 0)->text().toInt();
 
-    const auto& employees = controller->getEmployees();
     const auto& computers = controller->getComputers();
 
-    for (const auto& e : employees) {
-        if (e.id == empId && e.status == "Уволен") {
-            QMessageBox::warning(this, "Ошибка", "Нельзя назначить ПК уволенному сотруднику");
-            return;
-        }
+    const Employee* employee = controller->findEmployeeById(empId);
+    if (employee && employee->status == "Уволен") {
+        QMessageBox::warning(this, "Ошибка", "Нельзя назначить ПК уволенному сотруднику");
+        return;
     }
 
     if (computers.empty()) {
@@ -468,16 +465,12 @@ void EmployeesTabWidget::onAssignPc()
     QStringList items;
     for (const auto& c : computers) {
         QString suffix;
-        for (const auto& e : employees) {
-            if (e.computerId.has_value() &&
-                e.computerId.value() == c.id) {
-                QString initials = QString::fromStdString(e.initials);
-                QString name = QString::fromStdString(e.lastName);
-                if (!initials.isEmpty())
-                    name += " " + initials;
-                suffix = " (занят: " + name + ")";
-                break;
-            }
+        if (const Employee* owner = controller->ownerOf(c.id)) {
+            QString initials = QString::fromStdString(owner->initials);
+            QString name = QString::fromStdString(owner->lastName);
+            if (!initials.isEmpty())
+                name += " " + initials;
+            suffix = " (занят: " + name + ")";
         }
         QString info = "ID: " + QString::number(c.id) +
                        " | " + QString::fromStdString(c.inventoryNumber) +
@@ -510,13 +503,9 @@ void EmployeesTabWidget::onAssignPc()
 
     int assignedEmpId = -1;
     QString assignedEmpName;
-    for (const auto& e : employees) {
-        if (e.computerId.has_value() &&
-            e.computerId.value() == compId) {
-            assignedEmpId = e.id;
-            assignedEmpName = QString::fromStdString(e.lastName);
-            break;
-        }
+    if (const Employee* owner = controller->ownerOf(compId)) {
+        assignedEmpId = owner->id;
+        assignedEmpName = QString::fromStdString(owner->lastName);
     }
 
     if (assignedEmpId == empId) {
@@ -591,7 +580,6 @@ void EmployeesTabWidget::onShowFullTable()
     fullTable->horizontalHeader()->setStretchLastSection(true);
 
     const auto& employees = controller->getEmployees();
-    const auto& computers = controller->getComputers();
 
     auto safe = [](const std::string& value) {
         return value.empty() ? QString("-") : QString::fromStdString(value);
@@ -613,13 +601,10 @@ void EmployeesTabWidget::onShowFullTable()
 
         QString pcText = "-";
         if (e.computerId.has_value()) {
-            for (const auto& c : computers) {
-                if (c.id == e.computerId.value()) {
-                    pcText = "ID: " + QString::number(c.id) +
-                             " | " + safe(c.inventoryNumber) +
-                             " | " + safe(c.model);
-                    break;
-                }
+            if (const Computer* c = controller->findComputerById(e.computerId.value())) {
+                pcText = "ID: " + QString::number(c->id) +
+                         " | " + safe(c->inventoryNumber) +
+                         " | " + safe(c->model);
             }
         }
         fullTable->setItem(row, 10, new QTableWidgetItem(pcText));
@@ -648,17 +633,8 @@ void EmployeesTabWidget::updateDetails()
     }
 
     int id = table->item(row, 0)->text().toInt();
-    const auto& employees = controller->getEmployees();
-    const auto& computers = controller->getComputers();
-
-    const Employee* emp = nullptr;
-    for (const auto& e : employees) {
-        if (e.id == id) {
-            emp = &e;
-            break;
-        }
-    }
 
+    const Employee* emp = controller->findEmployeeById(id);
     if (!emp) {
         details->setText("Сотрудник не найден");
         return;
@@ -682,15 +658,11 @@ void EmployeesTabWidget::updateDetails()
 
     QString pcText = "-";
     if (emp->computerId.has_value()) {
-        int compId = emp->computerId.value();
-        for (const auto& c : computers) {
-            if (c.id == compId) {
-                pcText = "ID: " + QString::number(c.id) +
-                         " | " + QString::fromStdString(c.inventoryNumber) +
-                         " | " + QString::fromStdString(c.serialNumber) +
-                         " | " + QString::fromStdString(c.model);
-                break;
-            }
+        if (const Computer* c = controller->findComputerById(emp->computerId.value())) {
+            pcText = "ID: " + QString::number(c->id) +
+                     " | " + QString::fromStdString(c->inventoryNumber) +
+                     " | " + QString::fromStdString(c->serialNumber) +
+                     " | " + QString::fromStdString(c->model);
         }
     }
     text += "ПК: " + pcText;
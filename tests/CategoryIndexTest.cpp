@@ -0,0 +1,189 @@
+// Битовые карты категорий после добавления, изменения и удаления записей.
+// Удаление сдвигает позиции всех записей за удаленной: карты хранят ID,
+// а selectComputers переводит их в позиции - проверяется, что после
+// сдвигов результат совпадает с прямым просмотром записей.
+
+#include "core/Database.h"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAIL: " << what << "\n";
+        ++failures;
+    }
+}
+
+Employee makeEmployee(int i) {
+    Employee e{};
+    e.institute = "Институт " + std::to_string(i % 3);
+    e.department = "Кафедра " + std::to_string(i % 5);
+    e.lastName = "Сотрудник" + std::to_string(i);
+    e.status = i % 4 ? "Работает" : "Уволен";
+    return e;
+}
+
+Computer makeComputer(int i) {
+    Computer c{};
+    c.inventoryNumber = "INV-" + std::to_string(i);
+    c.serialNumber = "SN-" + std::to_string(i);
+    c.manufacturer = i % 2 ? "Dell" : "HP";
+    c.ramSize = 4 << (i % 3);
+    c.storageType = i % 3 ? "SSD" : "HDD";
+    c.storageSize = 256;
+    c.roomNumber = std::to_string(100 + i % 4);
+    c.condition = i % 5 ? "Рабочее" : "На ремонте";
+    return c;
+}
+
+std::vector<int> idsOf(const RoaringBitmap& bitmap) {
+    std::vector<int> ids;
+    bitmap.forEach([&ids](uint32_t id) { ids.push_back(static_cast<int>(id)); });
+    return ids;
+}
+
+template <typename Record, typename Match>
+std::vector<int> scanIds(const RecordTable<Record>& records, Match match) {
+    std::vector<int> ids;
+    for (const Record& record : records) {
+        if (match(record))
+            ids.push_back(record.id);
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+bool hasValue(const std::vector<InternedString>& values, const char* value) {
+    return std::find(values.begin(), values.end(), InternedString(value)) != values.end();
+}
+
+void checkEmployeeFilters(const Database& db, const std::string& stage) {
+    const InternedString institute("Институт 1");
+    const InternedString departmentA("Кафедра 2");
+    const InternedString departmentB("Кафедра 4");
+    const InternedString active("Работает");
+
+    std::vector<int> selected = idsOf(db.selectEmployeeIds({
+        { EmployeeCategory::Institute, { institute } },
+        { EmployeeCategory::Department, { departmentA, departmentB } },
+        { EmployeeCategory::Status, { active } } }));
+
+    std::vector<int> expected = scanIds(db.getEmployees(), [&](const Employee& e) {
+        return e.institute == institute &&
+               (e.department == departmentA || e.department == departmentB) &&
+               e.status == active;
+    });
+    check(selected == expected, stage + ": employee filters match a scan");
+
+    check(idsOf(db.selectEmployeeIds({})) == scanIds(db.getEmployees(), [](const Employee&) { return true; }),
+          stage + ": no filters select every employee");
+}
+
+void checkComputerFilters(const Database& db, const std::string& stage) {
+    const InternedString dell("Dell");
+    const InternedString ssd("SSD");
+    const InternedString working("Рабочее");
+
+    std::vector<ComputerCategoryFilter> filters = {
+        { ComputerCategory::Manufacturer, { dell } },
+        { ComputerCategory::StorageType, { ssd } },
+        { ComputerCategory::Condition, { working } } };
+    auto matches = [&](const Computer& c) {
+        return c.manufacturer == dell && c.storageType == ssd && c.condition == working;
+    };
+
+    check(idsOf(db.selectComputerIds(filters)) == scanIds(db.getComputers(), matches),
+          stage + ": computer filters match a scan");
+
+    // Позиции из selectComputers должны указывать на записи с теми же ID,
+    // что и в битовой карте, несмотря на сдвиги после удалений
+    const RecordTable<Computer>& computers = db.getComputers();
+    column_scan::Selection selection = db.selectComputers({ { ComputerColumn::Ram, 8, 16 } }, filters);
+    std::vector<int> selected;
+    selection.forEach([&](size_t slot) { selected.push_back(computers[slot].id); });
+    std::sort(selected.begin(), selected.end());
+
+    std::vector<int> expected = scanIds(computers, [&](const Computer& c) {
+        return matches(c) && c.ramSize >= 8 && c.ramSize <= 16;
+    });
+    check(selected == expected, stage + ": selectComputers slots match a scan");
+}
+
+}
+
+int main() {
+    Database db;
+    for (int i = 0; i < 200; ++i) {
+        db.addEmployee(makeEmployee(i));
+        db.addComputer(makeComputer(i));
+    }
+    checkEmployeeFilters(db, "after add");
+    checkComputerFilters(db, "after add");
+
+    // Изменение переносит ID из карты старого значения в карту нового
+    for (int id = 1; id <= 200; id += 7) {
+        Employee e = *db.findEmployeeById(id);
+        e.department = "Кафедра 4";
+        e.status = "Работает";
+        db.updateEmployee(e);
+
+        Computer c = *db.findComputerById(id);
+        c.manufacturer = "Dell";
+        c.condition = c.condition == "Рабочее" ? "На ремонте" : "Рабочее";
+        c.ramSize = 8;
+        db.updateComputer(c);
+    }
+    checkEmployeeFilters(db, "after update");
+    checkComputerFilters(db, "after update");
+
+    // Удаления из начала таблицы сдвигают позиции почти всех записей
+    for (int id = 2; id <= 200; id += 3) {
+        db.removeEmployee(id);
+        db.removeComputer(id);
+    }
+    checkEmployeeFilters(db, "after remove");
+    checkComputerFilters(db, "after remove");
+
+    // Добавленные после удалений записи попадают в карты с новыми ID
+    for (int i = 200; i < 230; ++i) {
+        db.addEmployee(makeEmployee(i));
+        db.addComputer(makeComputer(i));
+    }
+    checkEmployeeFilters(db, "after re-add");
+    checkComputerFilters(db, "after re-add");
+
+    // Значение без записей пропадает из списка значений
+    const RecordTable<Computer> computers = db.getComputers();
+    for (const Computer& c : computers) {
+        if (c.manufacturer == "HP") {
+            Computer changed = c;
+            changed.manufacturer = "Lenovo";
+            db.updateComputer(changed);
+        }
+    }
+    std::vector<InternedString> manufacturers = db.categoryValues(ComputerCategory::Manufacturer);
+    check(!hasValue(manufacturers, "HP"), "manufacturer without records is dropped");
+    check(hasValue(manufacturers, "Lenovo") && hasValue(manufacturers, "Dell"), "remaining manufacturers are listed");
+    check(db.selectComputerIds({ { ComputerCategory::Manufacturer, { InternedString("HP") } } }).empty(),
+          "filter by a dropped value selects nothing");
+
+    // После полной перестройки индексов (как при загрузке) результат тот же
+    Database loaded;
+    loaded.bulkLoad(std::vector<Employee>(db.getEmployees().begin(), db.getEmployees().end()),
+                    std::vector<Computer>(db.getComputers().begin(), db.getComputers().end()));
+    checkEmployeeFilters(loaded, "after bulkLoad");
+    checkComputerFilters(loaded, "after bulkLoad");
+    check(idsOf(loaded.selectComputerIds({})) == idsOf(db.selectComputerIds({})), "bulkLoad keeps computer ids");
+
+    if (failures)
+        return 1;
+    std::cout << "CategoryIndexTest: OK\n";
+    return 0;
+}
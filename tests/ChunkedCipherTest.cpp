@@ -0,0 +1,139 @@
+// Потоковое чтение блочного шифрования: блоки из std::istream по одному
+// (readChunk) и пачками (readAll) дают тот же открытый текст, что и
+// расшифровка на месте; поврежденный блок обнаруживается сам по себе,
+// а обрезка файла и лишние байты после последнего блока - как ошибка.
+
+#include "crypto/ChunkedCipher.h"
+#include "utils/ThreadPool.h"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAIL: " << what << "\n";
+        ++failures;
+    }
+}
+
+template <typename Action>
+bool throws(Action action) {
+    try {
+        action();
+    } catch (const std::exception&) {
+        return true;
+    }
+    return false;
+}
+
+const size_t kChunkSize = 1000;
+
+std::string encrypt(const CryptoKey& key, const std::vector<unsigned char>& plain, ThreadPool& pool) {
+    std::string sealed;
+    ChunkedEncryptor encryptor(key, [&sealed](const unsigned char* data, size_t size) {
+        sealed.append(reinterpret_cast<const char*>(data), size);
+    }, kChunkSize, pool);
+    encryptor.write(plain.data(), plain.size());
+    encryptor.finish();
+    return sealed;
+}
+
+std::vector<unsigned char> readByChunks(const std::string& sealed, const CryptoKey& key, ThreadPool& pool,
+                                        size_t* chunks = nullptr) {
+    std::istringstream in(sealed);
+    ChunkedDecryptor decryptor(in, pool);
+    decryptor.unlock(key.key);
+
+    std::vector<unsigned char> plain;
+    std::vector<unsigned char> chunk;
+    size_t count = 0;
+    try {
+        while (decryptor.readChunk(chunk)) {
+            plain.insert(plain.end(), chunk.begin(), chunk.end());
+            ++count;
+        }
+    } catch (...) {
+        if (chunks)
+            *chunks = count;
+        throw;
+    }
+    if (chunks)
+        *chunks = count;
+    return plain;
+}
+
+std::vector<unsigned char> readAll(const std::string& sealed, const CryptoKey& key, ThreadPool& pool) {
+    std::istringstream in(sealed);
+    ChunkedDecryptor decryptor(in, pool);
+    decryptor.unlock(key.key);
+
+    std::vector<unsigned char> plain;
+    decryptor.readAll(plain);
+    return plain;
+}
+
+}
+
+int main() {
+    ThreadPool pool(3);
+    CryptoKey key = CryptoService::deriveKey("test", CryptoService::makeKdfParams(1000));
+
+    // Несколько пачек по pool.size() блоков и неполный последний блок
+    std::vector<unsigned char> plain(kChunkSize * 10 + 123);
+    for (size_t i = 0; i < plain.size(); ++i)
+        plain[i] = static_cast<unsigned char>(i * 31 + (i >> 8));
+
+    const std::string sealed = encrypt(key, plain, pool);
+
+    size_t chunks = 0;
+    check(readByChunks(sealed, key, pool, &chunks) == plain, "readChunk restores the plaintext");
+    check(chunks == 11, "readChunk returns every chunk once");
+    check(readAll(sealed, key, pool) == plain, "readAll restores the plaintext");
+
+    std::vector<unsigned char> inPlace(sealed.begin(), sealed.end());
+    ChunkedDecryptor memory(inPlace.data(), inPlace.size(), pool);
+    memory.unlock(key.key);
+    size_t size = memory.decryptInPlace(inPlace.data() + memory.getHeaderSize(),
+                                        inPlace.size() - memory.getHeaderSize());
+    check(std::vector<unsigned char>(inPlace.begin() + memory.getHeaderSize(),
+                                     inPlace.begin() + memory.getHeaderSize() + size) == plain,
+          "stream and in-place decryption agree");
+
+    // Длина, кратная блоку: последний блок пустой, но присутствует
+    std::vector<unsigned char> whole(kChunkSize * 4, 7);
+    check(readByChunks(encrypt(key, whole, pool), key, pool) == whole, "exact multiple of the chunk size");
+    check(readAll(encrypt(key, {}, pool), key, pool).empty(), "empty plaintext");
+
+    // Подмена байта в четвертом блоке: первые три блока читаются
+    std::string tampered = sealed;
+    tampered[chunked_cipher::kHeaderSize + 3 * (kChunkSize + chunked_cipher::kTagSize) + 10] ^= 1;
+    chunks = 0;
+    check(throws([&]() { readByChunks(tampered, key, pool, &chunks); }), "readChunk rejects a tampered chunk");
+    check(chunks == 3, "chunks before the tampered one are returned");
+    check(throws([&]() { readAll(tampered, key, pool); }), "readAll rejects a tampered chunk");
+
+    // Обрезка по границе блока: последний полный блок не помечен последним
+    std::string cut = sealed.substr(0, chunked_cipher::kHeaderSize + 5 * (kChunkSize + chunked_cipher::kTagSize));
+    check(throws([&]() { readByChunks(cut, key, pool); }), "readChunk rejects a file cut at a chunk boundary");
+    check(throws([&]() { readAll(cut, key, pool); }), "readAll rejects a file cut at a chunk boundary");
+
+    check(throws([&]() { readByChunks(sealed + "x", key, pool); }), "readChunk rejects trailing bytes");
+    check(throws([&]() { readAll(sealed + "x", key, pool); }), "readAll rejects trailing bytes");
+
+    CryptoKey wrong = CryptoService::deriveKey("wrong", key.params);
+    check(throws([&]() { readAll(sealed, wrong, pool); }), "wrong key is rejected by the header check");
+
+    std::istringstream shortHeader(sealed.substr(0, chunked_cipher::kHeaderSize - 1));
+    check(throws([&]() { ChunkedDecryptor decryptor(shortHeader, pool); }), "truncated header is rejected");
+
+    if (failures)
+        return 1;
+    std::cout << "ChunkedCipherTest: OK\n";
+    return 0;
+}
@@ -0,0 +1,107 @@
+// Разделение блоков таблицы со снимками: снимок не видит последующих
+// изменений, а правка, удаление и добавление копируют только затронутый
+// блок; остальные блоки остаются общими (те же адреса записей).
+
+#include "core/Database.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAIL: " << what << "\n";
+        ++failures;
+    }
+}
+
+const size_t kChunk = RecordTable<Employee>::kChunkSize;
+
+RecordTable<Employee> makeTable(size_t count) {
+    std::vector<Employee> records(count);
+    for (size_t i = 0; i < count; ++i)
+        records[i].id = static_cast<int>(i + 1);
+    return RecordTable<Employee>(std::move(records));
+}
+
+std::vector<int> idsOf(const RecordTable<Employee>& table) {
+    std::vector<int> ids;
+    for (const Employee& e : table)
+        ids.push_back(e.id);
+    return ids;
+}
+
+bool sameRecord(const RecordTable<Employee>& a, const RecordTable<Employee>& b, size_t slot) {
+    return &a[slot] == &b[slot];
+}
+
+}
+
+int main() {
+    const size_t count = kChunk * 4 + 10;
+    RecordTable<Employee> table = makeTable(count);
+    const RecordTable<Employee> snapshot = table;
+    const std::vector<int> original = idsOf(snapshot);
+
+    check(sameRecord(table, snapshot, 0) && sameRecord(table, snapshot, count - 1), "copy shares every chunk");
+
+    // Правка копирует только свой блок
+    table.writable(kChunk + 5).lastName = "changed";
+    check(snapshot[kChunk + 5].lastName.empty(), "snapshot does not see an edit");
+    check(table[kChunk + 5].lastName == "changed", "table sees its edit");
+    check(!sameRecord(table, snapshot, kChunk), "edited chunk is copied");
+    check(sameRecord(table, snapshot, 0) && sameRecord(table, snapshot, 2 * kChunk),
+          "other chunks stay shared");
+
+    // Повторная правка того же блока его уже не копирует
+    const Employee* copied = &table[kChunk];
+    table.writable(kChunk + 6).lastName = "again";
+    check(&table[kChunk] == copied, "owned chunk is edited in place");
+
+    // Удаление сдвигает записи только внутри блока
+    table.erase(2 * kChunk + 1);
+    check(table.size() == count - 1 && snapshot.size() == count, "erase changes only the table size");
+    check(table[2 * kChunk + 1].id == original[2 * kChunk + 2], "records after the erased one shift");
+    check(&table[3 * kChunk - 1] == &snapshot[3 * kChunk], "following chunks stay shared after erase");
+    check(idsOf(snapshot) == original, "snapshot keeps every record after erase");
+
+    // Добавление в конец копирует только последний блок
+    Employee added{};
+    added.id = static_cast<int>(count + 1);
+    table.push_back(added);
+    check(table.back().id == added.id && snapshot.back().id == original.back(), "push_back is not visible in snapshot");
+    check(sameRecord(table, snapshot, 0), "push_back leaves the first chunk shared");
+
+    // Удаление целого блока и произвольный доступ после него
+    RecordTable<Employee> small = makeTable(kChunk + 3);
+    for (int i = 0; i < 3; ++i)
+        small.erase(kChunk);
+    check(small.size() == kChunk && small.back().id == static_cast<int>(kChunk), "emptied chunk is dropped");
+    for (size_t i = 0; i < kChunk; ++i)
+        small.erase(0);
+    check(small.empty() && small.begin() == small.end(), "table can be emptied");
+    small.push_back(added);
+    check(small.size() == 1 && small[0].id == added.id, "push_back after emptying");
+
+    // База: снимок не меняется от правок, сделанных после него
+    Database db;
+    Employee e{};
+    e.lastName = "Иванов";
+    int id = db.addEmployee(e);
+    DatabaseSnapshot before = db.snapshot();
+    e.id = id;
+    e.lastName = "Петров";
+    db.updateEmployee(e);
+    db.removeEmployee(id);
+    check(before.employees.size() == 1 && before.employees[0].lastName == "Иванов", "database snapshot is stable");
+    check(db.getEmployees().empty(), "database sees its own edits");
+
+    if (failures)
+        return 1;
+    std::cout << "RecordTableTest: OK\n";
+    return 0;
+}